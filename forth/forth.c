@@ -36,7 +36,8 @@
 // ---------------------------------------------------------------------------------------------------------------
 //                                                  STACK Gymnastics, CATCH and THROW
 // ---------------------------------------------------------------------------------------------------------------
-void forth_THROW(forth_runtime_context_t *ctx, forth_scell_t code)
+// Pass on an exception caught by C code (e.g. EVALUATE) without changing where it has been thrown.
+void forth_RETHROW(forth_runtime_context_t *ctx, forth_scell_t code)
 {
     jmp_buf *handler = (jmp_buf *)(ctx->throw_handler);
 
@@ -51,6 +52,54 @@ void forth_THROW(forth_runtime_context_t *ctx, forth_scell_t code)
     }
 }
 
+// The interpreter does not keep track of the word it is working on, the location of an error is taken from the input
+// source when the exception is thrown (see forth_NAME_BEFORE()).
+void forth_THROW(forth_runtime_context_t *ctx, forth_scell_t code)
+{
+    if (0 != code)
+    {
+		ctx->cold->error_source = ctx->source_address;
+		ctx->cold->error_source_length = ctx->source_length;
+		ctx->cold->error_position = ctx->to_in;
+		ctx->cold->error_line = ctx->line_no;
+
+		if ((0 != ctx->to_in) && (ctx->to_in <= ctx->source_length) && ('\n' == ctx->source_address[ctx->to_in - 1]))
+		{
+			ctx->cold->error_line--;	// The line end after the word has been counted already.
+		}
+		ctx->cold->error_source_id = ctx->source_id;
+		ctx->cold->error_blk = ctx->blk;
+		forth_RETHROW(ctx, code);
+    }
+}
+
+// Find the name in the LENGTH characters at SOURCE that ends before POSITION (the word the interpreter has been working on
+// when >IN was POSITION), return its address and store its length in *NAME_LENGTH (0 if there is none).
+static const char *forth_NAME_BEFORE(const char *source, forth_cell_t length, forth_cell_t position, forth_cell_t *name_length)
+{
+	const char *end = source + ((position < length) ? position : length);
+	const char *start;
+
+	*name_length = 0;
+
+	if (0 == source)
+	{
+		return 0;
+	}
+
+	while ((end > source) && isspace((int)(end[-1])))
+	{
+		end--;
+	}
+
+	for (start = end; (start > source) && !isspace((int)(start[-1])); start--)
+	{
+	}
+
+	*name_length = (forth_cell_t)(end - start);
+	return start;
+}
+
 // Check if the stack contains at least n items.
 void forth_CHECK_STACK_AT_LEAST(forth_runtime_context_t *ctx, forth_cell_t n)
 {
@@ -61,25 +110,31 @@ void forth_CHECK_STACK_AT_LEAST(forth_runtime_context_t *ctx, forth_cell_t n)
 }
 
 // Push an item to the data stack, perform stack checking.
+// With FORTH_GUARDED_STACKS the check is done by the guard page below the stack (see forth_GUARDED_STACK_FAULT()).
 void forth_PUSH(forth_runtime_context_t *ctx, forth_ucell_t x)
 {
     ctx->sp -= 1;
+#if !defined(FORTH_GUARDED_STACKS)
     if (ctx->sp < ctx->sp_min)
     {
         forth_THROW(ctx, -3);  // Stack overflow.
     }
+#endif
     *(ctx->sp) = x;
 }
 
 // Pop an item from the data stack, perform stack checking.
+// With FORTH_GUARDED_STACKS sp_max is the first cell of the guard page above the stack, reading it faults.
 forth_cell_t forth_POP(forth_runtime_context_t *ctx)
 {
     forth_cell_t x = *(ctx->sp++);
 
+#if !defined(FORTH_GUARDED_STACKS)
     if (ctx->sp > ctx->sp_max)
     {
         forth_THROW(ctx, -4); // Stack underflow.
     }
+#endif
     return x;
 }
 
@@ -111,10 +166,12 @@ void forth_DPUSH(forth_runtime_context_t *ctx, forth_dcell_t ud)
 void forth_RPUSH(forth_runtime_context_t *ctx, forth_ucell_t x)
 {
     ctx->rp -= 1;
+#if !defined(FORTH_GUARDED_STACKS)
     if (ctx->rp < ctx->rp_min)
     {
         forth_THROW(ctx, -5); // Return stack overflow.
     }
+#endif
     *(ctx->rp) = x;
 }
 
@@ -123,13 +180,45 @@ forth_cell_t forth_RPOP(forth_runtime_context_t *ctx)
 {
     forth_cell_t x = *(ctx->rp++);
 
+#if !defined(FORTH_GUARDED_STACKS)
     if (ctx->rp > ctx->rp_max)
     {
         forth_THROW(ctx, -6);  // Return stack underflow.
     }
+#endif
     return x;
 }
 
+#if defined(FORTH_GUARDED_STACKS)
+// The application's fault handler calls this when ADDR (the address of a memory access that has faulted) is in the
+// guard pages around the stacks of CTX. The guard pages must be directly below sp_min / rp_min and start at sp_max / rp_max.
+// Throw the same exception as the checks in forth_PUSH(), etc. would, return if ADDR is not next to the stacks of CTX.
+void forth_GUARDED_STACK_FAULT(forth_runtime_context_t *ctx, const void *addr, forth_cell_t guard_size)
+{
+	const char *p = (const char *)addr;
+
+	if ((p < (const char *)(ctx->sp_min)) && (p >= ((const char *)(ctx->sp_min) - guard_size)))
+	{
+		forth_THROW(ctx, -3); // Stack overflow.
+	}
+
+	if ((p >= (const char *)(ctx->sp_max)) && (p < ((const char *)(ctx->sp_max) + guard_size)))
+	{
+		forth_THROW(ctx, -4); // Stack underflow.
+	}
+
+	if ((p < (const char *)(ctx->rp_min)) && (p >= ((const char *)(ctx->rp_min) - guard_size)))
+	{
+		forth_THROW(ctx, -5); // Return stack overflow.
+	}
+
+	if ((p >= (const char *)(ctx->rp_max)) && (p < ((const char *)(ctx->rp_max) + guard_size)))
+	{
+		forth_THROW(ctx, -6); // Return stack underflow.
+	}
+}
+#endif
+
 void forth_EXECUTE(forth_runtime_context_t *ctx, forth_xt_t xt)
 {
     if (0 == xt)
@@ -155,7 +244,14 @@ void forth_EXECUTE(forth_runtime_context_t *ctx, forth_xt_t xt)
 			break;
 
 		case FORTH_XT_FLAGS_ACTION_THREADED:
-			forth_InnerInterpreter(ctx, xt);
+			if (0 == ctx->ip)
+			{
+				forth_InnerInterpreter(ctx, xt);	// Called from C code, run XT to completion.
+			}
+			else
+			{
+				forth_NEST(ctx, xt);				// Called from threaded code, the loop in forth_RUN_THREADED() carries on.
+			}
 			break;
 
 		case FORTH_XT_FLAGS_ACTION_VARIABLE:
@@ -209,38 +305,143 @@ void forth_execute(forth_runtime_context_t *ctx)
 	forth_EXECUTE(ctx, xt);
 }
 
-// Interpreter for threaded code.
-void forth_InnerInterpreter(forth_runtime_context_t *ctx, forth_xt_t xt)
+// Enter the threaded definition XT from threaded code.
+// The return address is saved on the return stack and IP is pointed to the body of XT, there is no recursion on C's stack,
+// the loop in forth_RUN_THREADED() simply carries on with the new IP.
+// With local variables the frame pointer is also saved if either the caller or XT uses one, bit 0 of the return address
+// indicates that the saved frame pointer is underneath it. While a definition without locals runs FP is 0.
+void forth_NEST(forth_runtime_context_t *ctx, forth_xt_t xt)
 {
-	forth_xt_t x;
-
-	forth_RPUSH(ctx, (forth_cell_t)ctx->ip);
-
 #if defined(FORTH_INCLUDE_LOCALS)
-	if (0 != (FORTH_XT_FLAGS_LOCALS & ((forth_vocabulary_entry_t *)xt)->flags))
+	if ((0 != ctx->fp) || (0 != (FORTH_XT_FLAGS_LOCALS & ((forth_vocabulary_entry_t *)xt)->flags)))
 	{
 		forth_RPUSH(ctx, (forth_cell_t)ctx->fp);
-		ctx->fp = ctx->rp;
+		forth_RPUSH(ctx, 1 | (forth_cell_t)ctx->ip);
+		ctx->fp = (0 != (FORTH_XT_FLAGS_LOCALS & ((forth_vocabulary_entry_t *)xt)->flags)) ? ctx->rp : 0;
 	}
+	else
 #endif
+	{
+		forth_RPUSH(ctx, (forth_cell_t)ctx->ip);
+	}
+
+	ctx->ip = (forth_token_t *)&(xt->meaning);
+
+	FORTH_COUNT_STEP(ctx, 1);
+}
 
-	ctx->ip = &(xt->meaning);
+// Return from a threaded definition, the counterpart of forth_NEST().
+void forth_UNNEST(forth_runtime_context_t *ctx)
+{
+	forth_cell_t ret;
 
-	while (0 != *(ctx->ip))
+#if defined(FORTH_INCLUDE_LOCALS)
+	if (0 != ctx->fp)
 	{
-		x = (forth_xt_t)*(ctx->ip++);
-		forth_EXECUTE(ctx, x);
+		ctx->rp = ctx->fp; // Discard the local variables.
 	}
 
-#if defined(FORTH_INCLUDE_LOCALS)
-	if (0 != (FORTH_XT_FLAGS_LOCALS & ((forth_vocabulary_entry_t *)xt)->flags))
+	ret = forth_RPOP(ctx);
+
+	if (0 != (1 & ret))
 	{
-		ctx->rp = ctx->fp;
 		ctx->fp = (forth_cell_t *)forth_RPOP(ctx);
+		ret &= ~(forth_cell_t)1;
 	}
+#else
+	ret = forth_RPOP(ctx);
 #endif
 
-	ctx->ip = (forth_cell_t *)forth_RPOP(ctx);
+	ctx->ip = (forth_token_t *)ret;
+}
+
+// The loop of the inner interpreter, it runs until IP becomes 0.
+void forth_RUN_THREADED(forth_runtime_context_t *ctx)
+{
+	forth_token_t x;
+
+	while (0 != ctx->ip)
+	{
+		x = *(ctx->ip++);
+
+		if (0 == x)
+		{
+			forth_UNNEST(ctx);
+		}
+		else
+		{
+			forth_EXECUTE(ctx, forth_TOKEN_TO_XT(ctx, x));
+		}
+	}
+}
+
+// Interpreter for threaded code, called from C code to run XT to completion.
+// The return address pushed here is 0, so the loop stops when XT returns.
+void forth_InnerInterpreter(forth_runtime_context_t *ctx, forth_xt_t xt)
+{
+	forth_token_t *saved_ip = ctx->ip;
+
+	ctx->nesting++;
+	ctx->ip = 0;
+	forth_NEST(ctx, xt);
+	forth_RUN_THREADED(ctx);
+	ctx->nesting--;
+	ctx->ip = saved_ip;
+}
+
+// The instruction budget (see Forth_RunWithBudget()) has run out.
+// If all the state of the interpreter is in CTX, i.e. the outer interpreter is between two words (LEVEL 0) or only the
+// threaded code it has started is running (LEVEL 1), return to Forth_RunWithBudget() / Forth_Resume().
+// Otherwise (e.g. inside CATCH, EVALUATE or LOAD) the C code in between cannot be suspended, so throw an exception,
+// the budget is left at one step so the next step tries again after the exception has been handled.
+void forth_OUT_OF_STEPS(forth_runtime_context_t *ctx, forth_cell_t level)
+{
+	if ((0 != ctx->suspend_handler) && (level == ctx->nesting))
+	{
+		longjmp(*(jmp_buf *)(ctx->suspend_handler), FORTH_EXIT_OUT_OF_STEPS);
+	}
+
+	ctx->steps_left = 1;
+	forth_THROW(ctx, FORTH_THROW_BUDGET_EXHAUSTED);
+}
+
+// The primitive F has got FORTH_WOULD_BLOCK from the input device (or it has run out of the input given to Forth_Feed()).
+// If F has been executed directly by the outer interpreter or by the threaded code it has started, IP (or >IN) is moved back
+// so that F is executed again once more input is available, and the interpreter returns FORTH_WOULD_BLOCK to the application.
+// Otherwise this function returns and the caller has to deal with the missing input.
+void forth_WAIT_FOR_INPUT(forth_runtime_context_t *ctx, forth_behavior_t f)
+{
+	forth_xt_t xt;
+	const char *name;
+	forth_cell_t name_length;
+
+	if (0 == ctx->suspend_handler)
+	{
+		return;
+	}
+
+	if ((1 == ctx->nesting) && (0 != ctx->ip))
+	{
+		xt = forth_TOKEN_TO_XT(ctx, ctx->ip[-1]);
+
+		if ((FORTH_XT_FLAGS_ACTION_PRIMITIVE == (xt->flags & FORTH_XT_FLAGS_ACTION_MASK)) && ((forth_cell_t)f == xt->meaning))
+		{
+			ctx->ip -= 1;
+			longjmp(*(jmp_buf *)(ctx->suspend_handler), FORTH_EXIT_WOULD_BLOCK);
+		}
+	}
+	else if ((0 == ctx->nesting) && (0 == ctx->ip) && (0 == ctx->state))
+	{
+		// Was the last word found by the outer interpreter F?
+		name = forth_NAME_BEFORE(ctx->source_address, ctx->source_length, ctx->to_in, &name_length);
+		xt = (0 != name_length) ? (forth_xt_t)forth_FIND_NAME(ctx, name, name_length) : 0;
+
+		if ((0 != xt) && (FORTH_XT_FLAGS_ACTION_PRIMITIVE == (xt->flags & FORTH_XT_FLAGS_ACTION_MASK)) && ((forth_cell_t)f == xt->meaning))
+		{
+			ctx->to_in = (forth_cell_t)(name - ctx->source_address);
+			longjmp(*(jmp_buf *)(ctx->suspend_handler), FORTH_EXIT_WOULD_BLOCK);
+		}
+	}
 }
 
 #if !defined(FORTH_WITHOUT_COMPILATION)
@@ -250,8 +451,8 @@ void forth_InnerInterpreter(forth_runtime_context_t *ctx, forth_xt_t xt)
 // So this implementation will work.
 void forth_exit(forth_runtime_context_t *ctx)
 {
-	static const forth_cell_t the_end = 0;
-	ctx->ip = (forth_cell_t *)&the_end;
+	static const forth_token_t the_end = 0;
+	ctx->ip = (forth_token_t *)&the_end;
 }
 #endif
 
@@ -290,8 +491,8 @@ void forth_pabortq(forth_runtime_context_t *ctx)
 
 	if (0 != f)
 	{
-		ctx->abort_msg_addr = addr;
-		ctx->abort_msg_len = len;
+		ctx->cold->abort_msg_addr = addr;
+		ctx->cold->abort_msg_len = len;
     	forth_THROW(ctx, -2);
 	}
 }
@@ -319,7 +520,7 @@ void forth_catch(forth_runtime_context_t *ctx)
     forth_ucell_t *saved_sp = ctx->sp;
     forth_ucell_t *saved_rp = ctx->rp;
     forth_ucell_t saved_handler = ctx->throw_handler;
-	forth_cell_t *saved_ip = ctx->ip;
+	forth_token_t *saved_ip = ctx->ip;
     jmp_buf catch_frame;
 
     res = setjmp(catch_frame);
@@ -352,6 +553,7 @@ void forth_catch(forth_runtime_context_t *ctx)
 {
     int res;
     forth_ucell_t *saved_rp;
+    forth_cell_t saved_nesting = ctx->nesting;
     jmp_buf catch_frame;
 
     if ((ctx->rp - 3) < ctx->rp_min)
@@ -378,16 +580,20 @@ void forth_catch(forth_runtime_context_t *ctx)
 
     if (0 == res)
     {
-//		ctx->ip = 0;
+		ctx->ip = 0;	// Run XT to completion even if CATCH was called from threaded code (see forth_EXECUTE()).
+		ctx->nesting++;
         ctx->throw_handler = (forth_ucell_t)(&catch_frame);
         forth_execute(ctx);
+		ctx->nesting = saved_nesting;
+		ctx->ip = (forth_token_t *)saved_rp[2];
         forth_PUSH(ctx, 0);
     }
     else
     {
+		ctx->nesting = saved_nesting;
 		ctx->rp = saved_rp;
         ctx->sp = (forth_cell_t *)ctx->rp[1];
-		ctx->ip = (forth_cell_t *)ctx->rp[2];
+		ctx->ip = (forth_token_t *)ctx->rp[2];
 #if defined(FORTH_INCLUDE_LOCALS)
 		ctx->fp = (forth_cell_t *)ctx->rp[3];
 #endif
@@ -1400,6 +1606,90 @@ void forth_compare(forth_runtime_context_t *ctx)
 // ---------------------------------------------------------------------------------------------------------------
 //                                                  Terminal I/O
 // ---------------------------------------------------------------------------------------------------------------
+#if defined(FORTH_INCLUDE_OUTPUT_BUFFER)
+// The output is collected in the cold context and given to the output device in big pieces instead of a character or
+// a number at a time. The buffer is flushed when it is full, by CR, PAGE and AT-XY, before waiting for input, when the
+// context lets others run (PAUSE, the end of a task's turn or a job) and when control returns to the application.
+
+// Give the buffered output to the output device.
+int forth_FLUSH_OUTPUT(forth_runtime_context_t *ctx)
+{
+	forth_cell_t count = ctx->cold->output_count;
+
+	if (0 == count)
+	{
+		return 0;
+	}
+
+	ctx->cold->output_count = 0;
+
+	if (0 > ctx->write_string(ctx, ctx->cold->output_buffer, count))
+	{
+		ctx->cold->output_failed = 1;	// Some callers cannot throw, the application still has to know.
+		return -1;
+	}
+
+	return 0;
+}
+
+// Flush the output before returning RES to the application.
+// If any output has been lost since the last return a successful RES becomes -57.
+forth_scell_t forth_FLUSH_ON_RETURN(forth_runtime_context_t *ctx, forth_scell_t res)
+{
+	(void)forth_FLUSH_OUTPUT(ctx);
+
+	if (0 != ctx->cold->output_failed)
+	{
+		ctx->cold->output_failed = 0;
+		res = (0 == res) ? -57 : res;
+	}
+
+	return res;
+}
+#endif
+
+// Write LENGTH characters at STR to the output device (through the output buffer if there is one).
+int forth_WRITE_STRING(forth_runtime_context_t *ctx, const char *str, forth_cell_t length)
+{
+#if defined(FORTH_INCLUDE_OUTPUT_BUFFER)
+	forth_cold_context_t *cold = ctx->cold;
+	int res;
+
+	if (length > (FORTH_OUTPUT_BUFFER_LENGTH - cold->output_count))
+	{
+		res = forth_FLUSH_OUTPUT(ctx);
+
+		if ((0 > res) || (length >= FORTH_OUTPUT_BUFFER_LENGTH))
+		{
+			return (0 > res) ? res : ctx->write_string(ctx, str, length); // Too long to be worth copying.
+		}
+	}
+
+	memcpy(cold->output_buffer + cold->output_count, str, length);
+	cold->output_count += length;
+	return 0;
+#else
+	return ctx->write_string(ctx, str, length);
+#endif
+}
+
+// Start a new line on the output device.
+int forth_SEND_CR(forth_runtime_context_t *ctx)
+{
+	int res = forth_FLUSH_OUTPUT(ctx);
+
+	return (0 > res) ? res : ctx->send_cr(ctx);
+}
+
+// FLUSH-OUTPUT ( -- )
+void forth_flush_output(forth_runtime_context_t *ctx)
+{
+	if (0 > forth_FLUSH_OUTPUT(ctx))
+	{
+		forth_THROW(ctx, -57);
+	}
+}
+
 // TYPE ( c-addr len -- )
 void forth_type(forth_runtime_context_t *ctx)
 {
@@ -1412,7 +1702,7 @@ void forth_type(forth_runtime_context_t *ctx)
         return;
     }
 
-    res = ctx->write_string(ctx, (const char *)addr, len);
+    res = forth_WRITE_STRING(ctx, (const char *)addr, len);
 
     if (0 > res)
     {
@@ -1438,7 +1728,7 @@ void forth_TYPE0(forth_runtime_context_t *ctx, const char *str)
 		return;
 	}
 
-	res = ctx->write_string(ctx, str, len);
+	res = forth_WRITE_STRING(ctx, str, len);
 	(void)res;
     /* Just ignore errors here for now........
 	if (0 > res)
@@ -1450,7 +1740,7 @@ void forth_TYPE0(forth_runtime_context_t *ctx, const char *str)
 
 void forth_EMIT(forth_runtime_context_t *ctx, char c)
 {
-    int res = ctx->write_string(ctx, &c, 1);
+    int res = forth_WRITE_STRING(ctx, &c, 1);
 
     if (0 > res)
     {
@@ -1477,6 +1767,11 @@ void forth_at_xy(forth_runtime_context_t *ctx)
 		forth_THROW(ctx, -21);
 	}
 
+	if (0 > forth_FLUSH_OUTPUT(ctx))
+	{
+		forth_THROW(ctx, -57);
+	}
+
     res = ctx->at_xy(ctx, x, y);
 
     if (0 > res)
@@ -1495,6 +1790,11 @@ void forth_page(forth_runtime_context_t *ctx)
 		forth_THROW(ctx, -21);
 	}
 
+	if (0 > forth_FLUSH_OUTPUT(ctx))
+	{
+		forth_THROW(ctx, -57);
+	}
+
     res = ctx->page(ctx);
 
     if (0 > res)
@@ -1506,7 +1806,7 @@ void forth_page(forth_runtime_context_t *ctx)
 // CR ( -- )
 void forth_cr(forth_runtime_context_t *ctx)
 {
-    int res = ctx->send_cr(ctx);
+    int res = forth_SEND_CR(ctx);
 
     if (0 > res)
     {
@@ -1551,6 +1851,11 @@ void forth_ekey_q(forth_runtime_context_t *ctx)
 		forth_THROW(ctx, -21);
 	}
 
+	if (0 > forth_FLUSH_OUTPUT(ctx))
+	{
+		forth_THROW(ctx, -57);
+	}
+
 	res = ctx->ekey_q(ctx);
 
 	if (0 > res)
@@ -1571,8 +1876,19 @@ void forth_ekey(forth_runtime_context_t *ctx)
 		forth_THROW(ctx, -21);
 	}
 
+	if (0 > forth_FLUSH_OUTPUT(ctx))
+	{
+		forth_THROW(ctx, -57);
+	}
+
 	res = ctx->ekey(ctx);
 
+	if ((forth_cell_t)(FORTH_WOULD_BLOCK) == res)
+	{
+		forth_WAIT_FOR_INPUT(ctx, forth_ekey);
+		forth_THROW(ctx, -57);
+	}
+
 	if (FORTH_TRUE == res)
 	{
 		forth_THROW(ctx, -57);
@@ -1586,11 +1902,22 @@ void forth_key_q(forth_runtime_context_t *ctx)
 {
     forth_cell_t res;
 
+	if (0 != ctx->cold->feed_address)
+	{
+		forth_PUSH(ctx, (0 != ctx->cold->feed_length) ? FORTH_TRUE : FORTH_FALSE);
+		return;
+	}
+
 	if (0 == ctx->key_q)
 	{
 		forth_THROW(ctx, -21);
 	}
 
+	if (0 > forth_FLUSH_OUTPUT(ctx))
+	{
+		forth_THROW(ctx, -57);
+	}
+
 	res = ctx->key_q(ctx);
 
 	if (0 > res)
@@ -1606,12 +1933,39 @@ void forth_key(forth_runtime_context_t *ctx)
 {
     forth_cell_t res;
 
-	if (0 == ctx->key)
+	if (0 != ctx->cold->feed_address)
 	{
-		forth_THROW(ctx, -21);
+		// Input given to Forth_Feed().
+		if (0 == ctx->cold->feed_length)
+		{
+			res = (forth_cell_t)(FORTH_WOULD_BLOCK);
+		}
+		else
+		{
+			res = (forth_cell_t)*(const unsigned char *)(ctx->cold->feed_address++);
+			ctx->cold->feed_length--;
+		}
+	}
+	else
+	{
+		if (0 == ctx->key)
+		{
+			forth_THROW(ctx, -21);
+		}
+
+		if (0 > forth_FLUSH_OUTPUT(ctx))
+		{
+			forth_THROW(ctx, -57);
+		}
+
+		res = ctx->key(ctx);
 	}
 
-	res = ctx->key(ctx);
+	if ((forth_cell_t)(FORTH_WOULD_BLOCK) == res)
+	{
+		forth_WAIT_FOR_INPUT(ctx, forth_key);
+		forth_THROW(ctx, -57);
+	}
 
 	if (FORTH_TRUE == res)
 	{
@@ -1621,6 +1975,47 @@ void forth_key(forth_runtime_context_t *ctx)
 	forth_PUSH(ctx, res);
 }
 
+// Read a line using the input device or from the input given to Forth_Feed().
+// Return the length of the line, a negative number if there is no more input (-57 if the output device has failed)
+// or FORTH_WOULD_BLOCK.
+static forth_scell_t forth_ACCEPT_LINE(forth_runtime_context_t *ctx, char *buffer, forth_cell_t length)
+{
+	forth_scell_t res;
+	char c;
+
+	if (0 == ctx->cold->feed_address)
+	{
+		if (0 > forth_FLUSH_OUTPUT(ctx))
+		{
+			return -57;	// There is no point reading more if the output cannot be written.
+		}
+
+		return (0 == ctx->accept_string) ? -1 : ctx->accept_string(ctx, buffer, length);
+	}
+
+	// The characters of an incomplete line stay in BUFFER, the next call (after Forth_Feed() has been given more input)
+	// carries on where this one has stopped.
+	while (0 != ctx->cold->feed_length)
+	{
+		c = *(ctx->cold->feed_address++);
+		ctx->cold->feed_length--;
+
+		if ('\n' == c)
+		{
+			res = (forth_scell_t)(ctx->cold->feed_pending);
+			ctx->cold->feed_pending = 0;
+			return res;
+		}
+
+		if (('\r' != c) && (ctx->cold->feed_pending < length))
+		{
+			buffer[ctx->cold->feed_pending++] = c;
+		}
+	}
+
+	return FORTH_WOULD_BLOCK;
+}
+
 // ACCEPT ( buff-addr buff-len -- str-len )
 void forth_accept(forth_runtime_context_t *ctx)
 {
@@ -1628,12 +2023,25 @@ void forth_accept(forth_runtime_context_t *ctx)
     forth_cell_t buffer_addr = forth_POP(ctx);
 	forth_scell_t l;
 
-    if (0 == ctx->accept_string)
+    if ((0 == ctx->accept_string) && (0 == ctx->cold->feed_address))
 	{
 		forth_THROW(ctx, -21);
 	}
 
-    l = ctx->accept_string(ctx, (char *)buffer_addr, len);
+	if (0 > forth_FLUSH_OUTPUT(ctx))
+	{
+		forth_THROW(ctx, -57);
+	}
+
+    l = forth_ACCEPT_LINE(ctx, (char *)buffer_addr, len);
+
+	if (FORTH_WOULD_BLOCK == l)
+	{
+		forth_PUSH(ctx, buffer_addr);
+		forth_PUSH(ctx, len);
+		forth_WAIT_FOR_INPUT(ctx, forth_accept);
+		forth_THROW(ctx, -57);
+	}
 #if 0
     if (0 > l)
     {
@@ -1660,6 +2068,35 @@ void forth_spaces(forth_runtime_context_t *ctx)
     }
 }
 
+// Read the next line from the user input device into the terminal input buffer and make it the input source.
+// Return the result of forth_ACCEPT_LINE().
+static forth_scell_t forth_REFILL_TIB(forth_runtime_context_t *ctx)
+{
+	forth_scell_t res;
+
+	ctx->blk = 0;
+	ctx->source_length = 0;
+	ctx->source_address = ctx->cold->tib;
+	ctx->to_in = 0;
+	ctx->line_no = 0;
+
+	if (0 == ctx->cold->input_buffers)
+	{
+		ctx->source_address = 0;
+		return -1;	// A task has no terminal input buffer, for it the input has ended.
+	}
+
+	res = forth_ACCEPT_LINE(ctx, ctx->cold->tib, FORTH_TIB_SIZE);
+
+	if (0 <= res)
+	{
+		ctx->cold->tib_count = res;
+		ctx->source_length = res;
+	}
+
+	return res;
+}
+
 // REFILL ( -- flag )
 void forth_refill(forth_runtime_context_t *ctx)
 {
@@ -1683,32 +2120,14 @@ void forth_refill(forth_runtime_context_t *ctx)
 #endif
     if (0 == ctx->source_id)
     {
-        ctx->blk = 0;
-        ctx->source_length = 0;
-        ctx->source_address = ctx->tib;
-        ctx->to_in = 0;
-		ctx->line_no = 0;
+        res = forth_REFILL_TIB(ctx);
 
-        if (0 == ctx->accept_string)
-        {
-            forth_PUSH(ctx, FORTH_FALSE);
-        }
-        else
-        {
-            res = ctx->accept_string(ctx, ctx->tib, FORTH_TIB_SIZE);
-
-            if (0 > res)
-            {
-                forth_PUSH(ctx, FORTH_FALSE);
-            }
-            else
-            {
-                ctx->tib_count = res;
-                ctx->source_length = res;
-                forth_PUSH(ctx, FORTH_TRUE);   
-            }
-        }
+		if (FORTH_WOULD_BLOCK == res)
+		{
+			forth_WAIT_FOR_INPUT(ctx, forth_refill);
+		}
 
+        forth_PUSH(ctx, (0 > res) ? FORTH_FALSE : FORTH_TRUE);
     }
     else if ((-1 == ctx->source_id) || (-2 == ctx->source_id))
     {
@@ -1717,9 +2136,10 @@ void forth_refill(forth_runtime_context_t *ctx)
     else
     {
 #if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
-        // We could have someting here if files were supported.......
-#endif
+        forth_PUSH(ctx, forth_REFILL_FILE(ctx) ? FORTH_TRUE : FORTH_FALSE);
+#else
         forth_PUSH(ctx, FORTH_FALSE);
+#endif
     }
 }
 // ---------------------------------------------------------------------------------------------------------------
@@ -1757,28 +2177,28 @@ static char *forth_FORMAT_UNSIGNED(forth_cell_t value, forth_cell_t base, forth_
 
 int forth_HDOT(forth_runtime_context_t *ctx, forth_cell_t value)
 {
-	char *buffer = ctx->num_buff;
+	char *buffer = ctx->cold->num_buff;
 	char *end = buffer + (FORTH_CELL_HEX_DIGITS) + 1;
 	char *p;
 	*end = FORTH_CHAR_SPACE;
 	p = forth_FORMAT_UNSIGNED(value, 16, FORTH_CELL_HEX_DIGITS, end);
-	return ctx->write_string(ctx, p, (end - p) + 1);
+	return forth_WRITE_STRING(ctx, p, (end - p) + 1);
 }
 
 int forth_UDOT(forth_runtime_context_t *ctx, forth_cell_t base, forth_cell_t value)
 {
-	char *buffer = ctx->num_buff;
-	char *end = buffer + (sizeof(ctx->num_buff) - 1);
+	char *buffer = ctx->cold->num_buff;
+	char *end = buffer + (sizeof(ctx->cold->num_buff) - 1);
 	char *p;
 	*end = FORTH_CHAR_SPACE;
 	p = forth_FORMAT_UNSIGNED(value, base, 1, end);
-	return ctx->write_string(ctx, p, (end - p) + 1);
+	return forth_WRITE_STRING(ctx, p, (end - p) + 1);
 }
 
 int forth_DOT(forth_runtime_context_t *ctx, forth_cell_t base, forth_cell_t value)
 {
-	char *buffer = ctx->num_buff;
-	char *end = buffer + (sizeof(ctx->num_buff) - 1);
+	char *buffer = ctx->cold->num_buff;
+	char *end = buffer + (sizeof(ctx->cold->num_buff) - 1);
 	forth_scell_t val = (forth_scell_t)value;
 	char *p;
 	*end = FORTH_CHAR_SPACE;
@@ -1791,13 +2211,13 @@ int forth_DOT(forth_runtime_context_t *ctx, forth_cell_t base, forth_cell_t valu
 	{
 		*--p = '-';
 	}
-	return ctx->write_string(ctx, p, (end - p) + 1);
+	return forth_WRITE_STRING(ctx, p, (end - p) + 1);
 }
 
 int forth_DOT_R(forth_runtime_context_t *ctx, forth_cell_t base, forth_cell_t value, forth_cell_t width, forth_cell_t is_signed)
 {
-	char *buffer = ctx->num_buff;
-	char *end = buffer + (sizeof(ctx->num_buff) - 1);
+	char *buffer = ctx->cold->num_buff;
+	char *end = buffer + (sizeof(ctx->cold->num_buff) - 1);
 	forth_scell_t val = (forth_scell_t)value;
 	char *p;
 	forth_cell_t nlen;
@@ -1822,15 +2242,15 @@ int forth_DOT_R(forth_runtime_context_t *ctx, forth_cell_t base, forth_cell_t va
 
 	for (i = nlen; i < width; i++)
 	{
-		ctx->write_string(ctx, &c, 1);
+		forth_WRITE_STRING(ctx, &c, 1);
 	}
 
-	return ctx->write_string(ctx, p, nlen);
+	return forth_WRITE_STRING(ctx, p, nlen);
 }
 
 static void forth_check_numbuff(forth_runtime_context_t *ctx)
 {
-	if (ctx->numbuff_ptr < ctx->num_buff)
+	if (ctx->cold->numbuff_ptr < ctx->cold->num_buff)
 	{
 		forth_THROW(ctx, -17); // pictured numeric output string overflow
 	}
@@ -1839,13 +2259,13 @@ static void forth_check_numbuff(forth_runtime_context_t *ctx)
 // <# ( -- )
 void forth_less_hash(forth_runtime_context_t *ctx)
 {
-	ctx->numbuff_ptr = &(ctx->num_buff[FORTH_NUM_BUFF_LENGTH]);
+	ctx->cold->numbuff_ptr = &(ctx->cold->num_buff[FORTH_NUM_BUFF_LENGTH]);
 }
 
 // HOLD ( char -- )
 void forth_hold(forth_runtime_context_t *ctx)
 {
-	*(--(ctx->numbuff_ptr)) = (char)forth_POP(ctx);
+	*(--(ctx->cold->numbuff_ptr)) = (char)forth_POP(ctx);
 	forth_check_numbuff(ctx);
 }
 
@@ -1886,7 +2306,7 @@ void forth_hash(forth_runtime_context_t *ctx)
 	}
 
 	dtos = forth_DPOP(ctx);
-	*(--(ctx->numbuff_ptr)) = forth_VAL2DIGIT((forth_byte_t)(dtos % base));
+	*(--(ctx->cold->numbuff_ptr)) = forth_VAL2DIGIT((forth_byte_t)(dtos % base));
 	forth_check_numbuff(ctx);
 	dtos = dtos / base;
 	forth_DPUSH(ctx, dtos);
@@ -1906,8 +2326,8 @@ void forth_hash_s(forth_runtime_context_t *ctx)
 void forth_hash_greater(forth_runtime_context_t *ctx)
 {
 	forth_CHECK_STACK_AT_LEAST(ctx, 2);
-	ctx->sp[1] = (forth_cell_t)(ctx->numbuff_ptr);
-	ctx->sp[0] = (forth_cell_t)(&(ctx->num_buff[FORTH_NUM_BUFF_LENGTH]) - ctx->numbuff_ptr);
+	ctx->sp[1] = (forth_cell_t)(ctx->cold->numbuff_ptr);
+	ctx->sp[0] = (forth_cell_t)(&(ctx->cold->num_buff[FORTH_NUM_BUFF_LENGTH]) - ctx->cold->numbuff_ptr);
 }
 
 int forth_DOTS(forth_runtime_context_t *ctx)
@@ -1928,7 +2348,7 @@ int forth_DOTS(forth_runtime_context_t *ctx)
 
 	*--p = '[';
 
-	res = ctx->write_string(ctx, p, (end - p));
+	res = forth_WRITE_STRING(ctx, p, (end - p));
 
 	if (res < 0)
 	{
@@ -1951,7 +2371,7 @@ int forth_DOTS(forth_runtime_context_t *ctx)
 			*--p = '-';
 		}
 
-		res = ctx->write_string(ctx, p, (end - p));
+		res = forth_WRITE_STRING(ctx, p, (end - p));
 
 		if (res < 0)
 		{
@@ -1959,14 +2379,14 @@ int forth_DOTS(forth_runtime_context_t *ctx)
 		}
 	}
 
-	return ctx->send_cr(ctx);
+	return forth_SEND_CR(ctx);
 }
 // -----------------------------------------------------------------
 void forth_PRINT_TRACE(forth_runtime_context_t *ctx, forth_xt_t xt)
 {
 	if (0 != xt)
 	{
-		if (0 != xt->name)
+		if (0 != FORTH_ENTRY_NAME(xt))
 		{
 			if (0 > forth_HDOT(ctx, (forth_cell_t)(ctx->ip)))
 			{
@@ -1974,7 +2394,7 @@ void forth_PRINT_TRACE(forth_runtime_context_t *ctx, forth_xt_t xt)
 			}
 
 			forth_TYPE0(ctx, ": ");
-			forth_TYPE0(ctx, (const char *)(xt->name));
+			forth_TYPE0(ctx, FORTH_ENTRY_NAME(xt));
 			forth_space(ctx);
 			forth_dots(ctx);
 			//forth_cr(ctx);
@@ -2100,12 +2520,12 @@ int forth_DUMP(struct forth_runtime_context *ctx, const char *addr, forth_cell_t
 	 	{
 			if (i)
             {
-                if (0 > ctx->write_string(ctx, buff,8))
+                if (0 > forth_WRITE_STRING(ctx, buff,8))
 				{
 					return -1;
 				}
             }
-			ctx->send_cr(ctx);
+			forth_SEND_CR(ctx);
 			forth_HDOT(ctx, (forth_cell_t)addr);
             forth_TYPE0(ctx, ": "); 
 			memset(buff,FORTH_CHAR_SPACE, 8);
@@ -2115,7 +2535,7 @@ int forth_DUMP(struct forth_runtime_context *ctx, const char *addr, forth_cell_t
  		buff[i % 8] = ( (c <128) && (c>31) ) ? c : '.';
 		byte_buffer[0] = forth_VAL2DIGIT(0x0F & (c >> 4));
 		byte_buffer[1] = forth_VAL2DIGIT(0x0F & c);
-      	if (0 > ctx->write_string(ctx, byte_buffer, 3))
+      	if (0 > forth_WRITE_STRING(ctx, byte_buffer, 3))
 		{
 			return -1;
 		}
@@ -2130,15 +2550,15 @@ int forth_DUMP(struct forth_runtime_context *ctx, const char *addr, forth_cell_t
 
 		for (i = (8 - cnt); i != 0; i--)
 		{
-      		if (0 > ctx->write_string(ctx, byte_buffer, 3))
+      		if (0 > forth_WRITE_STRING(ctx, byte_buffer, 3))
 			{
 				return -1;
 			}
 		}		
 	}
 
-   	ctx->write_string(ctx, buff, cnt);
-	return ctx->send_cr(ctx);
+   	forth_WRITE_STRING(ctx, buff, cnt);
+	return forth_SEND_CR(ctx);
 }
 
 // DUMP ( addr count -- )
@@ -2162,6 +2582,82 @@ static int forth_IsEOL(char c)
 {
 	return ('\r' == c) || ('\n' == c) || ('\f' == c) || (0 == c);
 }
+
+#if defined(FORTH_SWAR_PARSING)
+// Scanning the input a cell at a time (SIMD within a register): the parsing loops below skip whole cells while none of
+// their bytes is interesting, then the byte by byte code finds the exact spot (so the byte order does not matter).
+#define FORTH_SWAR_ONES		(FORTH_TRUE / 0xff)
+#define FORTH_SWAR_LOWS		(FORTH_SWAR_ONES * 0x7f)
+#define FORTH_SWAR_HIGHS	(FORTH_SWAR_ONES * 0x80)
+
+static forth_ucell_t forth_SWAR_LOAD(const char *p)
+{
+	forth_ucell_t x;
+
+	memcpy(&x, p, sizeof(x));	// Unaligned.
+	return x;
+}
+
+// The high bit of a byte of the result is set if and only if that byte of X is C.
+static forth_ucell_t forth_SWAR_EQ(forth_ucell_t x, char c)
+{
+	x ^= FORTH_SWAR_ONES * (uint8_t)c;
+	return ~(((x & FORTH_SWAR_LOWS) + FORTH_SWAR_LOWS) | x | FORTH_SWAR_LOWS);
+}
+
+// The high bit of a byte of the result is set if and only if that byte of X is less than N (N <= 128).
+static forth_ucell_t forth_SWAR_LESS(forth_ucell_t x, unsigned int n)
+{
+	return ~(((x & FORTH_SWAR_LOWS) + (FORTH_SWAR_ONES * (128 - n))) | x) & FORTH_SWAR_HIGHS;
+}
+
+// Return the number of bytes at BUFF (a multiple of the cell size, at most LEN) that contain no delimiter and no EOL,
+// with FORTH_CHAR_SPACE as the delimiter no white space.
+// It may stop early at other control characters (white space and EOLs are all at most FORTH_CHAR_SPACE), the byte by
+// byte code sorts them out.
+static forth_cell_t forth_SWAR_SCAN(const char *buff, forth_cell_t len, char delimiter)
+{
+	forth_cell_t n = 0;
+	forth_ucell_t x;
+	forth_ucell_t hit;
+
+	while (sizeof(forth_ucell_t) <= (len - n))
+	{
+		x = forth_SWAR_LOAD(buff + n);
+
+		if (FORTH_CHAR_SPACE == delimiter)
+		{
+			hit = forth_SWAR_LESS(x, FORTH_CHAR_SPACE + 1);
+		}
+		else
+		{
+			hit = forth_SWAR_LESS(x, '\r' + 1) | forth_SWAR_EQ(x, delimiter);
+		}
+
+		if (0 != hit)
+		{
+			break;
+		}
+
+		n += sizeof(forth_ucell_t);
+	}
+
+	return n;
+}
+
+// Return the number of bytes at BUFF (a multiple of the cell size, at most LEN) that are all spaces.
+static forth_cell_t forth_SWAR_SPACES(const char *buff, forth_cell_t len)
+{
+	forth_cell_t n = 0;
+
+	while ((sizeof(forth_ucell_t) <= (len - n)) && ((FORTH_SWAR_ONES * FORTH_CHAR_SPACE) == forth_SWAR_LOAD(buff + n)))
+	{
+		n += sizeof(forth_ucell_t);
+	}
+
+	return n;
+}
+#endif
 #if 0
 static void forth_SKIP_DELIMITERS(const char **buffer, forth_cell_t *length, char delimiter)
 {
@@ -2201,6 +2697,9 @@ static void forth_SkipWhiteSpace(const char **buffer, forth_cell_t *length, fort
 {
 	const char *buff = *buffer;
 	forth_cell_t len = *length;
+#if defined(FORTH_SWAR_PARSING)
+	forth_cell_t skip;
+#endif
 
 	while ((0 != len) && isspace((int)(*buff)))
 	{
@@ -2219,6 +2718,11 @@ static void forth_SkipWhiteSpace(const char **buffer, forth_cell_t *length, fort
 
 		buff++;
 		len--;
+#if defined(FORTH_SWAR_PARSING)
+		skip = forth_SWAR_SPACES(buff, len);	// Indentation.
+		buff += skip;
+		len -= skip;
+#endif
 	}
 
 	*buffer = buff;
@@ -2230,12 +2734,21 @@ static forth_cell_t forth_ParseTillDelimiter(const char *buff, forth_cell_t *len
 	//const char *buff = *buffer;
 	forth_cell_t len = *length;
 	forth_cell_t token_length;
+#if defined(FORTH_SWAR_PARSING)
+	forth_cell_t skip;
+#endif
 
 #if defined(DEBUG_PARSE)
 	printf("-----------------------------------------------------------------\n");
 	write_str(buff, len);
 	printf("\n-----------------------------------------------------------------\n");
 #endif
+#if defined(FORTH_SWAR_PARSING)
+	skip = forth_SWAR_SCAN(buff, len, delimiter);
+	buff += skip;
+	len -= skip;
+#endif
+
 	if ((FORTH_CHAR_SPACE) == delimiter)
 	{
 		while ((0 != len) && !isspace((int)(*buff)))
@@ -2247,7 +2760,7 @@ static forth_cell_t forth_ParseTillDelimiter(const char *buff, forth_cell_t *len
 
 		token_length  = *length - len;
 
-		if (forth_IsEOL(*buff))
+		if ((0 != len) && forth_IsEOL(*buff))	// A mapped file may end at the end of a page.
 		{
 			*eol_count += 1;
 			if (('\r' == buff[0]) && (1 < len))
@@ -2270,8 +2783,8 @@ static forth_cell_t forth_ParseTillDelimiter(const char *buff, forth_cell_t *len
 
 		token_length  = *length - len;
 
-		*eol_count += 1;
-		if (('\r' == buff[0]) && (1 < len))
+		*eol_count += (0 != len) ? 1 : 0;
+		if ((1 < len) && ('\r' == buff[0]))
 		{
 			if ('\n' == buff[1])
 			{
@@ -2299,6 +2812,11 @@ static forth_cell_t forth_ParseTillDelimiter(const char *buff, forth_cell_t *len
 			// putchar(*buff);
 			buff++;
 			len--;
+#if defined(FORTH_SWAR_PARSING)
+			skip = forth_SWAR_SCAN(buff, len, delimiter);	// The rest of the line.
+			buff += skip;
+			len -= skip;
+#endif
 		}
 		token_length  = *length - len;
 	}
@@ -2308,16 +2826,12 @@ static forth_cell_t forth_ParseTillDelimiter(const char *buff, forth_cell_t *len
 	return token_length;
 }
 
-// ( delim -- c-addr len|0 )
-void forth_parse(forth_runtime_context_t *ctx)
+// Parse the input source up to DELIMITER, return the address of the string and store its length in *TOKEN_LENGTH.
+static const char *forth_PARSE(forth_runtime_context_t *ctx, char delimiter, forth_cell_t *token_length)
 {
-    char delimiter;
 	const char *address;
 	forth_cell_t length;
 	forth_cell_t eol_count = 0;
-	forth_cell_t token_length;
-
-    delimiter = (char)forth_POP(ctx);
 
 #if defined(DEBUG_PARSE)
 	printf("%s: addr = %p, len = %u, >IN = %u\n", __FUNCTION__, rctx->source_address, rctx->source_length, rctx->to_in);
@@ -2330,7 +2844,7 @@ void forth_parse(forth_runtime_context_t *ctx)
 #if defined(DEBUG_PARSE)
 		printf("%s (start) address=%p length=%u\n", __FUNCTION__, address, length);
 #endif
-		token_length = forth_ParseTillDelimiter(address, &length, delimiter, &eol_count);
+		*token_length = forth_ParseTillDelimiter(address, &length, delimiter, &eol_count);
 #if defined(DEBUG_PARSE)
 		printf("%s (ret) address=%p length=%u\n", __FUNCTION__, address, length);
 		rctx->write_string(rctx, address, length);
@@ -2345,14 +2859,21 @@ void forth_parse(forth_runtime_context_t *ctx)
 
 		ctx->line_no += eol_count;
 
-        forth_PUSH(ctx, (forth_cell_t)address);
-        forth_PUSH(ctx, token_length);
-	}
-	else
-	{
-        forth_PUSH(ctx, 0);
-        forth_PUSH(ctx, 0);
+		return address;
 	}
+
+	*token_length = 0;
+	return 0;
+}
+
+// ( delim -- c-addr len|0 )
+void forth_parse(forth_runtime_context_t *ctx)
+{
+	forth_cell_t length;
+	const char *address = forth_PARSE(ctx, (char)forth_POP(ctx), &length);
+
+	forth_PUSH(ctx, (forth_cell_t)address);
+	forth_PUSH(ctx, length);
 }
 
 // " ( <string> -- c-addr u )"
@@ -2370,8 +2891,11 @@ void forth_sliteral(forth_runtime_context_t *ctx)
 	const char *addr = (const char *)forth_POP(ctx);
 	forth_cell_t here;
 
+#if defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+	forth_ROOM(ctx, (2 * sizeof(forth_cell_t)) + FORTH_ALIGN(len) + FORTH_SEGMENT_COMPILE_ROOM);
+#endif
 	forth_COMPILE_COMMA(ctx, forth_SLIT_xt);
-	forth_COMMA(ctx, len);
+	forth_TOKEN_COMMA(ctx, (forth_token_t)len);
 	forth_here(ctx);
 	here = forth_POP(ctx);
 	forth_PUSH(ctx, len);
@@ -2394,14 +2918,11 @@ void forth_squot(forth_runtime_context_t *ctx)
 #endif
 }
 
-// https://forth-standard.org/standard/core/PARSE-NAME
-// ( "name" -- c-addr len|0 )
-void forth_parse_name(forth_runtime_context_t *ctx)
+// Skip white space and parse a name from the input source, return its address and store its length in *NAME_LENGTH (0 at the end of the input).
+static const char *forth_PARSE_NAME(forth_runtime_context_t *ctx, forth_cell_t *name_length)
 {
 	const char *address;
 	forth_cell_t length;
-    char dlm = FORTH_CHAR_SPACE;
-    //char dlm = (char)forth_POP(ctx);
 	forth_cell_t eol_count = 0;
 
 
@@ -2427,33 +2948,105 @@ void forth_parse_name(forth_runtime_context_t *ctx)
 		ctx->to_in += length;
 		ctx->line_no += eol_count;
 
-        forth_PUSH(ctx, dlm);
-		forth_parse(ctx);
-	}
-	else
-	{
-        forth_PUSH(ctx, 0);
-        forth_PUSH(ctx, 0);
+		return forth_PARSE(ctx, FORTH_CHAR_SPACE, name_length);
 	}
+
+	*name_length = 0;
+	return 0;
+}
+
+// https://forth-standard.org/standard/core/PARSE-NAME
+// ( "name" -- c-addr len|0 )
+void forth_parse_name(forth_runtime_context_t *ctx)
+{
+	forth_cell_t length;
+	const char *address = forth_PARSE_NAME(ctx, &length);
+
+	forth_PUSH(ctx, (forth_cell_t)address);
+	forth_PUSH(ctx, length);
 }
 
 // ---------------------------------------------------------------------------------------------------------------
 static forth_byte_t map_digit(char c)
 {
 	// ASCII
-	if ((c >= '0') && (c <= '9'))
+	forth_byte_t d = (forth_byte_t)(c - '0');
+
+	if (d < 10)
+	{
+		return d;
+	}
+
+	d = (forth_byte_t)((c | 0x20) - 'a');	// Either case.
+
+	return (d < 26) ? (forth_byte_t)(10 + d) : 255;
+}
+
+#if defined(FORTH_SWAR_PARSING) && defined(FORTH_IS_64BIT)
+// Convert decimal digits at BUFF eight at a time while there are at least eight of them, accumulating in *X.
+// Return the number of characters used.
+static forth_cell_t forth_SWAR_DECIMAL(const char *buff, forth_cell_t len, forth_cell_t *x)
+{
+	static const uint16_t one = 1;
+	forth_cell_t n = 0;
+	forth_ucell_t v;
+
+	if (0 == *(const uint8_t *)&one)
+	{
+		return 0;	// The digits are combined assuming little endian byte order.
+	}
+
+	while (8 <= (len - n))
 	{
-		return c - '0';
+		v = forth_SWAR_LOAD(buff + n);
+
+		if (0 != (forth_SWAR_LESS(v, '0') | (~forth_SWAR_LESS(v, '9' + 1) & FORTH_SWAR_HIGHS)))
+		{
+			break;
+		}
+
+		v -= FORTH_SWAR_ONES * '0';
+		v = (v * 10) + (v >> 8);	// Pairs of digits.
+		v = (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)))
+			+ (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+		*x = (*x * 100000000) + v;
+		n += 8;
 	}
-	else if ((c >= 'a') && (c <= 'z'))
+
+	return n;
+}
+#endif
+
+// Convert the digits in BASE at BUFF with native arithmetic (the result is the same as the low cell of the double
+// cell one), return the number of characters used, it stops at the first character that is not a digit.
+static forth_cell_t forth_SINGLE_DIGITS(const char *buff, forth_cell_t len, forth_cell_t base, forth_cell_t *x)
+{
+	forth_cell_t n = 0;
+	forth_cell_t res = 0;
+	forth_byte_t b;
+
+#if defined(FORTH_SWAR_PARSING) && defined(FORTH_IS_64BIT)
+	if (10 == base)
 	{
-		return 10 + (c - 'a');
+		n = forth_SWAR_DECIMAL(buff, len, &res);
 	}
-	else if ((c >= 'A') && (c <= 'Z'))
+#endif
+
+	while (n < len)
 	{
-		return 10 + (c - 'A');
+		b = map_digit(buff[n]);
+
+		if (b >= base)
+		{
+			break;
+		}
+
+		res = (res * base) + b;
+		n++;
 	}
-	return 255;
+
+	*x = res;
+	return n;
 }
 
 //#define DEBUG_PROCESS_NUMBER
@@ -2469,7 +3062,8 @@ int forth_PROCESS_NUMBER(forth_runtime_context_t *ctx, const char *buff, forth_c
 	forth_dcell_t d = 0;
 	forth_byte_t b;
 	forth_cell_t base = ctx->base;
-
+	forth_cell_t x;
+	forth_cell_t n;
 
 #if defined(DEBUG_PROCESS_NUMBER)
 	printf("%s: buff = %p %lu\n",__FUNCTION__,buff, len);
@@ -2508,6 +3102,21 @@ int forth_PROCESS_NUMBER(forth_runtime_context_t *ctx, const char *buff, forth_c
 	}
 #endif
 
+	// The common case: a single cell number, no need for double cell arithmetic.
+	n = forth_SINGLE_DIGITS(buff, len, base, &x);
+
+	if (n == len)
+	{
+		*--(ctx->sp) = (-1 == sign) ? (0 - x) : x;
+		*--(ctx->sp) = 0;
+		return 0;
+	}
+
+	if ('.' != buff[n])
+	{
+		return -1;
+	}
+
 	while (0 != len)
 	{
 		c = *buff++;
@@ -2583,99 +3192,178 @@ void forth_to_number(forth_runtime_context_t *ctx)
 	forth_PUSH(ctx, len);
 }
 // ---------------------------------------------------------------------------------------------------------------
+// Execute XT, or compile it if it is not immediate and the interpreter is compiling.
+static void forth_INTERPRET_XT(forth_runtime_context_t *ctx, forth_xt_t xt)
+{
+#if !defined(FORTH_WITHOUT_COMPILATION)
+	if ((0 == ctx->state) || (0 != (FORTH_XT_FLAGS_IMMEDIATE & xt->flags)))
+	{
+#endif
+		forth_EXECUTE(ctx, xt);
+#if !defined(FORTH_WITHOUT_COMPILATION)
+	}
+	else
+	{
+		forth_COMPILE_COMMA(ctx, xt);
+	}
+#endif
+}
+
+// Deal with the number left on the stack by forth_PROCESS_NUMBER().
+static void forth_INTERPRET_NUMBER(forth_runtime_context_t *ctx)
+{
+#if !defined(FORTH_WITHOUT_COMPILATION)
+	if (0 == ctx->state)
+	{
+#endif
+		forth_drop(ctx);
+#if !defined(FORTH_WITHOUT_COMPILATION)
+	}
+	else
+	{
+		if (0 == forth_POP(ctx))
+		{
+			forth_literal(ctx);
+		}
+		else
+		{
+			forth_2literal(ctx);
+		}
+	}
+#endif
+}
+
+// The words are parsed and looked up directly (not through the data stack). The interpreter does not keep track of
+// where it is in the input for error reporting, that is rebuilt from >IN when an exception is thrown (see forth_THROW()).
 void forth_interpret(forth_runtime_context_t *ctx)
 {
     int res;
     forth_cell_t symbol_len;
-    forth_cell_t symbol_addr;
+    const char *symbol_addr;
 	forth_xt_t xt;
+	forth_token_t *saved_ip = ctx->ip;
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+	forth_eval_cursor_t cursor;
+	const forth_eval_token_t *token;
+	forth_cell_t from;
+#endif
+
+	ctx->ip = 0; // The words found in the input have to run to completion (see forth_EXECUTE()).
+
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+	forth_EVAL_CACHE_BEGIN(ctx, &cursor);
+#endif
 
     while(1)
     {
-        forth_parse_name(ctx);
-        symbol_len  = forth_POP(ctx);
-        symbol_addr = forth_POP(ctx);
+		FORTH_COUNT_STEP(ctx, 0);
+
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+		from = ctx->to_in;
+		token = forth_EVAL_CACHE_NEXT(ctx, &cursor);
+
+		if (0 != token)
+		{
+			ctx->to_in = token->to;
+			ctx->line_no = cursor.line_no + token->line;
+
+			if (FORTH_EVAL_TOKEN_END == token->kind)
+			{
+				ctx->ip = saved_ip;
+				return;
+			}
+
+			if (FORTH_EVAL_TOKEN_XT == token->kind)
+			{
+				forth_INTERPRET_XT(ctx, (forth_xt_t)(token->x));
+			}
+			else
+			{
+				forth_PUSH(ctx, token->x);
+
+				if (FORTH_EVAL_TOKEN_DOUBLE == token->kind)
+				{
+					forth_PUSH(ctx, token->high);
+					forth_PUSH(ctx, 1);
+				}
+				else
+				{
+					forth_PUSH(ctx, 0);
+				}
+
+				forth_INTERPRET_NUMBER(ctx);
+			}
+
+			forth_EVAL_CACHE_CHECK(ctx, &cursor);
+			continue;
+		}
+#endif
+
+        symbol_addr = forth_PARSE_NAME(ctx, &symbol_len);
 
         if (0 == symbol_len)
         {
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+			forth_EVAL_CACHE_RECORD(ctx, &cursor, from, FORTH_EVAL_TOKEN_END, 0);
+#endif
+			ctx->ip = saved_ip;
             return;
         }
 
-		ctx->symbol_addr = symbol_addr;
-		ctx->symbol_length = symbol_len;
-		ctx->symbol_line = ctx->line_no;
-		ctx->symbol_source_id = ctx->source_id;
-		ctx->symbol_blk = ctx->blk;
-		ctx->symbol_position = ctx->to_in;
-
 		xt = 0;
 
 #if defined(FORTH_INCLUDE_LOCALS)
 		if (0 != ctx->state)
 		{
-			xt = (forth_xt_t) forth_find_local(ctx, (const char *)symbol_addr, symbol_len, 0);
+			xt = (forth_xt_t) forth_find_local(ctx, symbol_addr, symbol_len, 0);
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+			if (0 != xt)
+			{
+				forth_EVAL_CACHE_RECORD(ctx, &cursor, from, FORTH_EVAL_TOKEN_LIVE, 0);
+			}
+#endif
 		}
 #endif
 		if (0 == xt)
 		{
-        	forth_PUSH(ctx, symbol_addr);
-        	forth_PUSH(ctx, symbol_len);
-        	forth_find_name(ctx);
-			xt = (forth_xt_t)forth_POP(ctx);
+			xt = (forth_xt_t)forth_FIND_NAME(ctx, symbol_addr, symbol_len);
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+			if (0 != xt)
+			{
+				forth_EVAL_CACHE_RECORD(ctx, &cursor, from, FORTH_EVAL_TOKEN_XT, (forth_cell_t)xt);
+			}
+#endif
 		}
 
         if (0 != xt)
         {
-#if !defined(FORTH_WITHOUT_COMPILATION)
-			if ((0 == ctx->state) || (0 != (FORTH_XT_FLAGS_IMMEDIATE & xt->flags)))
-			{
-#endif
-            	forth_EXECUTE(ctx, xt);
-#if !defined(FORTH_WITHOUT_COMPILATION)
-			}
-			else
-			{
-				forth_COMPILE_COMMA(ctx, xt);
-			}
-#endif
+			forth_INTERPRET_XT(ctx, xt);
         }
         else
         {
-            res = forth_PROCESS_NUMBER(ctx, (const char *)symbol_addr, symbol_len);
+            res = forth_PROCESS_NUMBER(ctx, symbol_addr, symbol_len);
  
             if (0 > res)
             {
                 forth_THROW(ctx, -13); // Undefined word.
             }
-#if !defined(FORTH_WITHOUT_COMPILATION)
-			if (0 == ctx->state)
-			{
-#endif
-            	forth_drop(ctx);
-#if !defined(FORTH_WITHOUT_COMPILATION)
-			}
-			else
-			{
-				if (0 == forth_POP(ctx))
-				{
-					forth_literal(ctx);
-				}
-				else
-				{
-					forth_2literal(ctx);
-				}
-			}
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+			forth_EVAL_CACHE_RECORD(ctx, &cursor, from, (0 == ctx->sp[0]) ? FORTH_EVAL_TOKEN_SINGLE : FORTH_EVAL_TOKEN_DOUBLE, 0);
 #endif
+			forth_INTERPRET_NUMBER(ctx);
         }
+
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+		forth_EVAL_CACHE_CHECK(ctx, &cursor);
+#endif
     }
 }
 // Comment ( "string" -- )
 void forth_paren(forth_runtime_context_t *ctx)
 {
-    forth_PUSH(ctx, (forth_cell_t)')');
-    forth_parse(ctx);
-    forth_drop(ctx);
-    forth_drop(ctx);
+	forth_cell_t length;
+
+	(void)forth_PARSE(ctx, ')', &length);
 }
 
 // .( ( "string" -- )
@@ -2689,6 +3377,7 @@ void forth_dot_paren(forth_runtime_context_t *ctx)
 // \ ( -- )
 void forth_backslash(forth_runtime_context_t *ctx)
 {
+	forth_cell_t length;
 #if defined(FORTH_INCLUDE_BLOCKS)
 	forth_cell_t in;
 	if (0 != ctx->blk)
@@ -2698,11 +3387,13 @@ void forth_backslash(forth_runtime_context_t *ctx)
 		return;
 	}
 #endif
-	if (-2 == ctx->source_id) // Kind of like a multi-line EVALUATE.
+	if ((-2 == ctx->source_id) // Kind of like a multi-line EVALUATE.
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+		|| ((0 != ctx->cold->including_mapped) && (ctx->source_id == ctx->cold->including)) // A whole file.
+#endif
+		)
 	{
-		forth_PUSH(ctx, (forth_cell_t)'\n');
-		forth_parse(ctx);
-		forth_2drop(ctx);
+		(void)forth_PARSE(ctx, '\n', &length);
 		return;
 	}
 	ctx->to_in = ctx->source_length;
@@ -2721,7 +3412,7 @@ void forth_PRINT_ERROR(forth_runtime_context_t *ctx, forth_scell_t code)
 		return;
 	}
 
-	if ((-2 == code) && (0 == ctx->abort_msg_len))
+	if ((-2 == code) && (0 == ctx->cold->abort_msg_len))
 	{
 		return;
 	}
@@ -2730,23 +3421,23 @@ void forth_PRINT_ERROR(forth_runtime_context_t *ctx, forth_scell_t code)
 // If needed port code here from EFCI, but currently not supported.
 #endif
 
-	if (0 == ctx->symbol_blk)
+	if (0 == ctx->cold->error_blk)
 	{
-		if ((0 != ctx->symbol_source_id) && (-1 != ctx->symbol_source_id))
+		if ((0 != ctx->cold->error_source_id) && (-1 != ctx->cold->error_source_id))
 		{
 			forth_TYPE0(ctx, " Line: ");
-			forth_DOT(ctx, 10, ctx->symbol_line + 1);
+			forth_DOT(ctx, 10, ctx->cold->error_line + 1);
 		}
 	}
 	else
 	{
 		forth_TYPE0(ctx, " BLK: #");
-		forth_DOT(ctx, 10, ctx->symbol_blk);
+		forth_DOT(ctx, 10, ctx->cold->error_blk);
 		//forth_TYPE0(ctx, " @position: ");
 		forth_TYPE0(ctx, "Line: ");
-		forth_DOT(ctx, 10, 1 + (ctx->symbol_position / 64));
+		forth_DOT(ctx, 10, 1 + (ctx->cold->error_position / 64));
 		forth_TYPE0(ctx," at ");
-		forth_DOT(ctx, 10, 1 + (ctx->symbol_position % 64));
+		forth_DOT(ctx, 10, 1 + (ctx->cold->error_position % 64));
 	}
 
 	forth_TYPE0(ctx, " Error: ");
@@ -2757,11 +3448,11 @@ void forth_PRINT_ERROR(forth_runtime_context_t *ctx, forth_scell_t code)
 	case 0: break; // Do nothing for 0.
 	case -1: forth_TYPE0(ctx, "ABORT"); break;
 	case -2:
-		if ((0 != ctx->abort_msg_len) && (0 != ctx->abort_msg_addr))
+		if ((0 != ctx->cold->abort_msg_len) && (0 != ctx->cold->abort_msg_addr))
 		{
-			ctx->write_string(ctx, (char *)(ctx->abort_msg_addr), ctx->abort_msg_len);
-			ctx->abort_msg_addr = 0;
-			ctx->abort_msg_len = 0;
+			forth_WRITE_STRING(ctx, (char *)(ctx->cold->abort_msg_addr), ctx->cold->abort_msg_len);
+			ctx->cold->abort_msg_addr = 0;
+			ctx->cold->abort_msg_len = 0;
 		}
 		else
 		{
@@ -2824,6 +3515,8 @@ void forth_PRINT_ERROR(forth_runtime_context_t *ctx, forth_scell_t code)
 	case -56: forth_TYPE0(ctx, "QUIT"); break;
 	case -57: forth_TYPE0(ctx, "exception in sending or receiving a character"); break;
 	case -58: forth_TYPE0(ctx, "[IF], [ELSE], or [THEN] exception"); break;
+	case FORTH_THROW_BUDGET_EXHAUSTED: forth_TYPE0(ctx, "instruction budget exhausted"); break;
+	case FORTH_THROW_TOO_MANY_JOBS: forth_TYPE0(ctx, "too many jobs"); break;
 	default:
 		// If there are locally defined exception codes get the error message here.
 		// Function prototype should be defined in forth_config.h.
@@ -2839,7 +3532,7 @@ void forth_PRINT_ERROR(forth_runtime_context_t *ctx, forth_scell_t code)
 		break;
 	}
 
-	ctx->send_cr(ctx);
+	forth_SEND_CR(ctx);
 }
 
 // .ERROR ( err -- )
@@ -2899,9 +3592,28 @@ void forth_bye(forth_runtime_context_t *ctx)
         forth_THROW(ctx, -21); // Unsupported operation -- any better idea???
     }
     
-    longjmp(*handler, -1);
+    longjmp(*handler, FORTH_EXIT_BYE);
 }
 // ---------------------------------------------------------------------------------------------------------------
+// Print the word where the outer interpreter has failed and the error message, and abandon the current definition.
+static void forth_INTERPRET_ERROR(forth_runtime_context_t *ctx, forth_scell_t res)
+{
+	forth_cell_t name_length;
+	const char *name = forth_NAME_BEFORE(ctx->cold->error_source, ctx->cold->error_source_length, ctx->cold->error_position, &name_length);
+
+	if (0 != name_length)
+	{
+		(void)forth_WRITE_STRING(ctx, name, name_length);
+	}
+
+	forth_PRINT_ERROR(ctx, res);
+	ctx->state = 0;
+#if defined(FORTH_INCLUDE_LOCALS)
+	ctx->dictionary->local_count = 0;
+#endif
+	ctx->defining = 0;
+}
+
 forth_scell_t forth_RUN_INTERPRET(forth_runtime_context_t *ctx)
 {
     forth_scell_t res;
@@ -2912,17 +3624,7 @@ forth_scell_t forth_RUN_INTERPRET(forth_runtime_context_t *ctx)
     res = forth_CATCH(ctx, forth_interpret_xt);
 	if (0 != res)
 	{
-		if ((0 != ctx->symbol_addr) && (0 != ctx->symbol_length))
-		{
-			(void)ctx->write_string(ctx, (const char *)(ctx->symbol_addr), ctx->symbol_length);
-		}
-
-    	forth_PRINT_ERROR(ctx, res);
-		ctx->state = 0;
-#if defined(FORTH_INCLUDE_LOCALS)
-		ctx->dictionary->local_count = 0;
-#endif
-		ctx->defining = 0;
+		forth_INTERPRET_ERROR(ctx, res);
 	}
     return res;
 }
@@ -3012,7 +3714,7 @@ void forth_EVAL(forth_runtime_context_t *ctx, forth_scell_t source_id)
         forth_ADJUST_BLK_INPUT_SOURCE(ctx, saved_blk);
     }
 #endif
-	forth_THROW(ctx, res);
+	forth_RETHROW(ctx, res);
 }
 
 // EVALUATE ( i * x c-addr u -- j * x )
@@ -3032,6 +3734,7 @@ void forth_quit(forth_runtime_context_t *ctx)
 {
     jmp_buf *handler;
     jmp_buf frame;
+	forth_scell_t res;
 
     if (0 != ctx->quit_handler)
     {
@@ -3045,18 +3748,27 @@ void forth_quit(forth_runtime_context_t *ctx)
     }
 
     ctx->rp = ctx->rp0;
+#if defined(FORTH_INCLUDE_LOCALS)
+	ctx->fp = 0;
+#endif
     ctx->throw_handler = 0;
     ctx->source_id = 0;
 	ctx->line_no = 0;
     ctx->state = 0;
+	ctx->cold->feed_pending = 0;
+	ctx->cold->session_line = 0;
 
     while(1)
     {
-        
+        res = forth_REFILL_TIB(ctx);
 
-        forth_refill(ctx);
+		if ((FORTH_WOULD_BLOCK == res) && (0 != ctx->bye_handler))
+		{
+			// Let the application wait for input, it can continue this session with Forth_Feed().
+			longjmp(*(jmp_buf *)(ctx->bye_handler), FORTH_EXIT_WOULD_BLOCK);
+		}
 
-        if (0 == forth_POP(ctx))
+        if (0 > res)
         {
             break;
         }
@@ -3069,12 +3781,12 @@ void forth_quit(forth_runtime_context_t *ctx)
         	// This can actually happen if the output can close (such as on a network connection).
 			if (0 == ctx->state)
         	{
-        		if ((0 == ctx->write_string) || (0 > ctx->write_string(ctx, "OK", 2)))
+        		if ((0 == ctx->write_string) || (0 > forth_WRITE_STRING(ctx, "OK", 2)))
         		{
         			break;
         		}
 
-            	if ((0 == ctx->send_cr) || (0 > ctx->send_cr(ctx)))
+            	if ((0 == ctx->send_cr) || (0 > forth_SEND_CR(ctx)))
             	{
             		break;
             	}
@@ -3084,6 +3796,9 @@ void forth_quit(forth_runtime_context_t *ctx)
 		{
 			ctx->sp = ctx->sp0;
 			ctx->rp = ctx->rp0;
+#if defined(FORTH_INCLUDE_LOCALS)
+			ctx->fp = 0;
+#endif
 		}
     }
 
@@ -3171,7 +3886,15 @@ forth_dictionary_t *Forth_InitDictionary(void *addr, forth_cell_t length)
 	dict = (forth_dictionary_t *)addr;
 	dict->dp = 0;
 	length -= FORTH_ALIGN(sizeof(forth_dictionary_t));
+#if defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+	length = (length & FORTH_ALIGNED_MASK) - FORTH_SEGMENT_RESERVE;
+	dict->segment = (forth_cell_t)(dict->items);
+#endif
 	dict->dp_max = length;
+#if defined(FORTH_SEPARATE_HEADS)
+	dict->dp_max &= FORTH_ALIGNED_MASK;	// The heads below it are cell aligned.
+	dict->heads = dict->dp_max;
+#endif
 	dict->forth_wl.link		= (forth_cell_t)&forth_root_wordlist;
 	dict->forth_wl.parent	= (forth_cell_t)&forth_root_wordlist;
 	dict->forth_wl.name		= (forth_cell_t)&(dict->items);
@@ -3182,20 +3905,118 @@ forth_dictionary_t *Forth_InitDictionary(void *addr, forth_cell_t length)
 	return dict;
 }
 
+#if defined(FORTH_SEPARATE_HEADS)
+// Return the length of the head space of DICTIONARY (the names and links of the words defined at runtime) and store
+// its address in *START. The threaded code does not refer to it, so it need not be kept in an image of the dictionary
+// that is only run (but SEE, the text interpreter, etc. will not find the words).
+forth_cell_t Forth_GetHeadSpace(forth_dictionary_t *dictionary, void **start)
+{
+	*start = FORTH_DICTIONARY_ITEMS(dictionary) + dictionary->dp_max;
+	return dictionary->heads - dictionary->dp_max;
+}
+#endif
+
+#if defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+// Let PROVIDER supply more memory when the dictionary is full (0 means that the dictionary cannot grow).
+void Forth_SetSegmentProvider(forth_dictionary_t *dictionary, forth_segment_provider_t provider)
+{
+	dictionary->more = provider;
+}
+
+// Make sure that there are at least N contiguous bytes available at HERE, chaining a new segment if necessary.
+// If a definition is being compiled its threaded code continues in the new segment (via (SEGMENT-BRANCH) which
+// always fits in the reserved end of the old segment), otherwise the rest of the old segment is left unused.
+void forth_ROOM(forth_runtime_context_t *ctx, forth_cell_t n)
+{
+	forth_dictionary_t *dict = ctx->dictionary;
+	forth_cell_t dp;
+	forth_cell_t length = 0;
+	forth_token_t *here;
+	forth_scell_t offset;
+#if defined(FORTH_TOKEN_THREADED)
+	forth_scell_t last;
+#endif
+	uint8_t *segment;
+
+	if (0 == dict)
+	{
+		forth_THROW(ctx, -21); // Unsupported opration.
+	}
+
+	FORTH_CHECK_DICTIONARY_FROZEN(ctx);
+
+	dp = FORTH_ALIGN(dict->dp);
+
+	if ((dp <= dict->dp_max) && (n <= (dict->dp_max - dp)))
+	{
+		return;
+	}
+
+	if (0 == dict->more)
+	{
+		forth_THROW(ctx, -8); // Dictionary overflow.
+	}
+
+	segment = (uint8_t *)dict->more(dict, n + FORTH_SEGMENT_RESERVE, &length);
+
+	if ((0 == segment) || (length < (n + FORTH_SEGMENT_RESERVE)) || (0 != ((forth_cell_t)segment & ~FORTH_ALIGNED_MASK)))
+	{
+		forth_THROW(ctx, -8); // Dictionary overflow.
+	}
+#if defined(FORTH_TOKEN_THREADED)
+	offset = (segment - (uint8_t *)dict) / (forth_scell_t)sizeof(forth_token_t);
+	last = offset + (forth_scell_t)(length / sizeof(forth_token_t));
+
+	if ((offset != (forth_stoken_t)offset) || (last != (forth_stoken_t)last))
+	{
+		forth_THROW(ctx, -8); // Dictionary overflow -- the words defined in the segment could not be compiled as tokens.
+	}
+#endif
+
+	if ((0 != ctx->state) && (dp <= dict->dp_max))
+	{
+		here = (forth_token_t *)(FORTH_DICTIONARY_ITEMS(dict) + FORTH_TOKEN_ALIGN(dict->dp));
+		offset = ((forth_token_t *)segment) - (here + 1);
+
+		if (offset != (forth_stoken_t)offset)
+		{
+			forth_THROW(ctx, -8); // Dictionary overflow -- the new segment is out of the reach of a token.
+		}
+
+		here[0] = forth_XT_TO_TOKEN(ctx, forth_SEGMENT_BRANCH_xt);
+		here[1] = (forth_token_t)offset;
+	}
+
+	dict->segment = (forth_cell_t)segment;
+	dict->dp = 0;
+	dict->dp_max = (length & FORTH_ALIGNED_MASK) - FORTH_SEGMENT_RESERVE;
+}
+#endif
+
 // BRANCH ( -- ) Compiled by some words such as ELSE and REPEAT.
 void forth_branch(forth_runtime_context_t *ctx)
 {
+	forth_scell_t offset;
+
 	if (0 == ctx->ip)
 	{
 		forth_THROW(ctx, -21); // Unsupported operation.
 	}
 
-	ctx->ip += (forth_cell_t)(ctx->ip[0]);
+	offset = (forth_stoken_t)(ctx->ip[0]);
+	ctx->ip += offset;
+
+	if (0 > offset)
+	{
+		FORTH_COUNT_STEP(ctx, 1); // A backward branch, i.e. a loop.
+	}
 }
 
 // 0BRACH ( flag -- ) Compiled by IF, WHILE, UNTIL, etc.
 void forth_0branch(forth_runtime_context_t *ctx)
 {
+	forth_scell_t offset;
+
 	if (0 == ctx->ip)
 	{
 		forth_THROW(ctx, -21); // Unsupported operation.
@@ -3203,7 +4024,13 @@ void forth_0branch(forth_runtime_context_t *ctx)
 
 	if (0 == forth_POP(ctx))
 	{
-		ctx->ip += (forth_cell_t)(ctx->ip[0]);
+		offset = (forth_stoken_t)(ctx->ip[0]);
+		ctx->ip += offset;
+
+		if (0 > offset)
+		{
+			FORTH_COUNT_STEP(ctx, 1); // A backward branch, i.e. a loop.
+		}
 	}
 	else
 	{
@@ -3219,7 +4046,7 @@ void forth_0branch(forth_runtime_context_t *ctx)
 // (DO) ( limit first -- )
 void forth_do_rt(forth_runtime_context_t *ctx)
 {
-	forth_cell_t *address_after;
+	forth_token_t *address_after;
 
 	if (0 == ctx->ip)
 	{
@@ -3228,7 +4055,7 @@ void forth_do_rt(forth_runtime_context_t *ctx)
 
 	//forth_TYPE0(ctx, "ip ="); forth_PUSH(ctx, (forth_cell_t)ctx->ip); forth_hdot(ctx); forth_cr(ctx);
 
-	address_after = ctx->ip + (forth_cell_t)(ctx->ip[0]);
+	address_after = ctx->ip + (forth_stoken_t)(ctx->ip[0]);
 
 	//forth_TYPE0(ctx, "address_after="); forth_PUSH(ctx, (forth_cell_t)address_after); forth_hdot(ctx); forth_cr(ctx);
 
@@ -3248,7 +4075,7 @@ void forth_do_rt(forth_runtime_context_t *ctx)
 // (?DO) ( limit first -- )
 void forth_qdo_rt(forth_runtime_context_t *ctx)
 {
-	forth_cell_t *address_after;
+	forth_token_t *address_after;
 	forth_cell_t index = forth_POP(ctx);
 	forth_cell_t limit = forth_POP(ctx);
 
@@ -3257,7 +4084,7 @@ void forth_qdo_rt(forth_runtime_context_t *ctx)
 		forth_THROW(ctx, -21); // Unsupported operation.
 	}
 
-	address_after = ctx->ip + (forth_cell_t)(ctx->ip[0]);
+	address_after = ctx->ip + (forth_stoken_t)(ctx->ip[0]);
 	ctx->ip++;
 
 	if (index == limit)
@@ -3297,7 +4124,7 @@ void forth_leave(forth_runtime_context_t *ctx)
         forth_THROW(ctx, -26);  // loop parameters unavailable
     }
 
-	ctx->ip = (forth_cell_t *)(ctx->rp[FORTH_DO_LOOP_LEAVE_ADDRESS]);
+	ctx->ip = (forth_token_t *)(ctx->rp[FORTH_DO_LOOP_LEAVE_ADDRESS]);
 	ctx->rp += 3;
 }
 
@@ -3346,7 +4173,8 @@ void forth_loop_rt(forth_runtime_context_t *ctx)
 	}
 	else
 	{
-		ctx->ip += (forth_cell_t)(ctx->ip[0]);
+		ctx->ip += (forth_stoken_t)(ctx->ip[0]);
+		FORTH_COUNT_STEP(ctx, 1);
 	}
 }
 
@@ -3375,7 +4203,8 @@ void forth_plus_loop_rt(forth_runtime_context_t *ctx)
 	tmp = (forth_scell_t)((ctx->rp[FORTH_DO_LOOP_I] - ctx->rp[FORTH_DO_LOOP_LIMIT]) ^ inc);
 	if (0 > tmp)
 	{
-		ctx->ip += (forth_cell_t)(ctx->ip[0]);
+		ctx->ip += (forth_stoken_t)(ctx->ip[0]);
+		FORTH_COUNT_STEP(ctx, 1);
 
 	}
 	else
@@ -3390,7 +4219,7 @@ void forth_do(forth_runtime_context_t *ctx)
 {
 	forth_COMPILE_COMMA(ctx, forth_pDO_xt); // (DO)
 	forth_here(ctx);
-	forth_COMMA(ctx, 0);
+	forth_TOKEN_COMMA(ctx, 0);
 	forth_PUSH(ctx, FORTH_DO_MARKER);
 }
 
@@ -3399,15 +4228,15 @@ void forth_q_do(forth_runtime_context_t *ctx)
 {
 	forth_COMPILE_COMMA(ctx, forth_pqDO_xt); // (?DO)
 	forth_here(ctx);
-	forth_COMMA(ctx, 0);
+	forth_TOKEN_COMMA(ctx, 0);
 	forth_PUSH(ctx, FORTH_DO_MARKER);
 }
 
 // LOOP ( -- )
 void forth_loop(forth_runtime_context_t *ctx)
 {
-	forth_cell_t *do_addr;
-	forth_cell_t *here;
+	forth_token_t *do_addr;
+	forth_token_t *here;
 
 	if (FORTH_DO_MARKER != forth_POP(ctx))
 	{
@@ -3415,19 +4244,19 @@ void forth_loop(forth_runtime_context_t *ctx)
 	}
 
 	forth_COMPILE_COMMA(ctx, forth_pLOOP_xt);
-	do_addr = (forth_cell_t *)forth_POP(ctx);
+	do_addr = (forth_token_t *)forth_POP(ctx);
 	forth_here(ctx);
-	here = (forth_cell_t *)forth_POP(ctx);
-	*do_addr = (forth_cell_t)((here + 1) - do_addr);
-	forth_COMMA(ctx, (forth_cell_t)((do_addr + 1) - here));
+	here = (forth_token_t *)forth_POP(ctx);
+	*do_addr = (forth_token_t)((here + 1) - do_addr);
+	forth_TOKEN_COMMA(ctx, (forth_token_t)((do_addr + 1) - here));
 	//printf("here = 0x%16lx\r\n", here);
 }
 
 // +LOOP ( n -- )
 void forth_plus_loop(forth_runtime_context_t *ctx)
 {
-	forth_cell_t *do_addr;
-	forth_cell_t *here;
+	forth_token_t *do_addr;
+	forth_token_t *here;
 
 	if (FORTH_DO_MARKER != forth_POP(ctx))
 	{
@@ -3435,11 +4264,11 @@ void forth_plus_loop(forth_runtime_context_t *ctx)
 	}
 
 	forth_COMPILE_COMMA(ctx, forth_ppLOOP_xt);
-	do_addr = (forth_cell_t *)forth_POP(ctx);
+	do_addr = (forth_token_t *)forth_POP(ctx);
 	forth_here(ctx);
-	here = (forth_cell_t *)forth_POP(ctx);
-	*do_addr = (forth_cell_t)((here + 1) - do_addr);
-	forth_COMMA(ctx, (forth_cell_t)((do_addr + 1) - here));
+	here = (forth_token_t *)forth_POP(ctx);
+	*do_addr = (forth_token_t)((here + 1) - do_addr);
+	forth_TOKEN_COMMA(ctx, (forth_token_t)((do_addr + 1) - here));
 }
 #endif
 
@@ -3495,8 +4324,38 @@ void forth_lit(forth_runtime_context_t *ctx)
 		forth_THROW(ctx, -9); // Invalid address.
 	}
 
-	forth_PUSH(ctx, (forth_cell_t) *(ctx->ip++));
+	forth_PUSH(ctx, (forth_cell_t)(forth_stoken_t) *(ctx->ip++));
+}
+
+// Compiled by XLITERAL and POSTPONE
+// ( -- xt )
+void forth_xlit(forth_runtime_context_t *ctx)
+{
+	forth_token_t t;
+
+	if (0 == ctx->ip)
+	{
+		forth_THROW(ctx, -9); // Invalid address.
+	}
+
+	t = *(ctx->ip++);
+	forth_PUSH(ctx, (0 == t) ? 0 : (forth_cell_t)forth_TOKEN_TO_XT(ctx, t));
+}
+
+#if defined(FORTH_TOKEN_THREADED)
+// Compiled by LITERAL when the number does not fit in a single token, the low half comes first.
+// ( -- x )
+void forth_wlit(forth_runtime_context_t *ctx)
+{
+	if (0 == ctx->ip)
+	{
+		forth_THROW(ctx, -9); // Invalid address.
+	}
+
+	forth_PUSH(ctx, ((forth_cell_t)(ctx->ip[0])) | (((forth_cell_t)(ctx->ip[1])) << 32));
+	ctx->ip += 2;
 }
+#endif
 
 // Compiled by SLITERAL
 // ( -- c-addr len )
@@ -3520,7 +4379,7 @@ void forth_slit(forth_runtime_context_t *ctx)
 	forth_PUSH(ctx, ip);
 	forth_PUSH(ctx, len);
 	ip += len;
-	ctx->ip = (forth_cell_t *)(FORTH_ALIGN(ip));
+	ctx->ip = (forth_token_t *)(FORTH_ALIGN(ip));
 }
 
 // HERE ( -- addr )
@@ -3531,10 +4390,11 @@ void forth_here(forth_runtime_context_t *ctx)
 		forth_THROW(ctx, -21); // Unsupported opration.
 	}
 
-	forth_PUSH(ctx, (forth_cell_t)&(ctx->dictionary->items[ctx->dictionary->dp]));
+	forth_PUSH(ctx, (forth_cell_t)&(FORTH_DICTIONARY_ITEMS(ctx->dictionary)[ctx->dictionary->dp]));
 }
 
 // UNUSED ( -- u )
+// With dictionary segments this is the room left in the current segment, i.e. what can be added to a definition.
 void forth_unused(forth_runtime_context_t *ctx)
 {
 	if (0 == ctx->dictionary)
@@ -3545,6 +4405,29 @@ void forth_unused(forth_runtime_context_t *ctx)
 	forth_PUSH(ctx, ctx->dictionary->dp_max - ctx->dictionary->dp);
 }
 
+#if defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+// CREATE <name> n ALLOT is the usual way to make a buffer, which might not fit in the current segment.
+// If nothing has been added to the body of the latest CREATEd word yet, its header is moved to a segment with room for N bytes.
+static void forth_MOVE_CREATED(forth_runtime_context_t *ctx, forth_cell_t n)
+{
+	forth_dictionary_t *dict = ctx->dictionary;
+	forth_vocabulary_entry_t *latest = forth_GET_LATEST(ctx);
+	forth_vocabulary_entry_t *entry;
+
+	if ((0 == latest) || (FORTH_XT_FLAGS_ACTION_CREATE != (latest->flags & FORTH_XT_FLAGS_ACTION_MASK))
+		|| ((forth_cell_t)(latest + 1) != (forth_cell_t)&(FORTH_DICTIONARY_ITEMS(dict)[dict->dp])))
+	{
+		return;
+	}
+
+	forth_ROOM(ctx, sizeof(forth_vocabulary_entry_t) + n);
+	entry = (forth_vocabulary_entry_t *)&(FORTH_DICTIONARY_ITEMS(dict)[dict->dp]);
+	memcpy(entry, latest, sizeof(forth_vocabulary_entry_t));	// The name stays where it was.
+	dict->dp += sizeof(forth_vocabulary_entry_t);
+	forth_SET_LATEST(ctx, entry);
+}
+#endif
+
 // ALLOT ( n -- )
 void forth_allot(forth_runtime_context_t *ctx)
 {
@@ -3556,8 +4439,18 @@ void forth_allot(forth_runtime_context_t *ctx)
 		forth_THROW(ctx, -21); // Unsupported opration.
 	}
 
+	FORTH_CHECK_DICTIONARY_FROZEN(ctx);
+
 	dp = n + ctx->dictionary->dp;
 
+#if defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+	if ((dp > ctx->dictionary->dp_max) && (0 < (forth_scell_t)n) && (0 == ctx->state))
+	{
+		forth_MOVE_CREATED(ctx, n);
+		dp = n + ctx->dictionary->dp;
+	}
+#endif
+
 	if (dp > ctx->dictionary->dp_max)
 	{
 		forth_THROW(ctx, -8); // Dictionary overflow.
@@ -3577,6 +4470,8 @@ void forth_align(forth_runtime_context_t *ctx)
 		forth_THROW(ctx, -21); // Unsupported opration.
 	}
 
+	FORTH_CHECK_DICTIONARY_FROZEN(ctx);
+
 	dp = ctx->dictionary->dp;
 	dp = FORTH_ALIGN(dp);
 
@@ -3617,8 +4512,10 @@ void forth_c_comma(forth_runtime_context_t *ctx)
 		forth_THROW(ctx, -21); // Unsupported opration.
 	}
 
+	FORTH_CHECK_DICTIONARY_FROZEN(ctx);
+
 	dp = ctx->dictionary->dp;
-	ctx->dictionary->items[dp++] = (uint8_t)chr;
+	FORTH_DICTIONARY_ITEMS(ctx->dictionary)[dp++] = (uint8_t)chr;
 
 	if (dp > ctx->dictionary->dp_max)
 	{
@@ -3639,6 +4536,8 @@ void forth_COMMA(forth_runtime_context_t *ctx, forth_cell_t x)
 		forth_THROW(ctx, -21); // Unsupported opration.
 	}
 
+	FORTH_CHECK_DICTIONARY_FROZEN(ctx);
+
 	ix = ctx->dictionary->dp;
 
 	if (ix != (ix & FORTH_ALIGNED_MASK))
@@ -3646,7 +4545,7 @@ void forth_COMMA(forth_runtime_context_t *ctx, forth_cell_t x)
 		forth_THROW(ctx, -23);	// Address alignment exception.
 	}
 
-	*(forth_cell_t *)&(ctx->dictionary->items[ix]) = x;
+	*(forth_cell_t *)&(FORTH_DICTIONARY_ITEMS(ctx->dictionary)[ix]) = x;
 	dp = ix + sizeof(forth_cell_t);
 
 	if (dp > ctx->dictionary->dp_max)
@@ -3657,6 +4556,98 @@ void forth_COMMA(forth_runtime_context_t *ctx, forth_cell_t x)
 	ctx->dictionary->dp = dp;
 }
 
+#if defined(FORTH_TOKEN_THREADED)
+// Encode XT as a token (see forth_TOKEN_TO_XT()), 0 stays 0 (i.e. EXIT).
+// The offset from the dictionary is preferred (it is the cheaper one to decode), even for words compiled in C when they
+// are close enough, otherwise a word compiled in C is looked up in forth_token_tables.
+forth_token_t forth_XT_TO_TOKEN(forth_runtime_context_t *ctx, forth_xt_t xt)
+{
+	const forth_vocabulary_entry_t **table;
+	const forth_vocabulary_entry_t *entry;
+	forth_scell_t offset;
+
+	if (0 == xt)
+	{
+		return 0;
+	}
+
+	if (0 != ctx->dictionary)
+	{
+		offset = (((uint8_t *)xt) - ((uint8_t *)(ctx->dictionary))) / (forth_scell_t)sizeof(forth_token_t);
+
+		if ((offset == (forth_stoken_t)offset) && (0 == (offset & 1)) && (xt == forth_TOKEN_TO_XT(ctx, (forth_token_t)offset)))
+		{
+			return (forth_token_t)offset;
+		}
+	}
+
+	for (table = forth_token_tables; 0 != *table; table++)
+	{
+		if (xt >= *table)
+		{
+			for (entry = *table; 0 != entry->name; entry++)
+			{
+				if ((entry == xt) && (FORTH_TOKEN_INDEX_MASK >= (forth_cell_t)(entry - *table)))
+				{
+					return (forth_token_t)(((table - forth_token_tables) << FORTH_TOKEN_TABLE_SHIFT) | ((entry - *table) << 1) | 1);
+				}
+			}
+		}
+	}
+
+	forth_THROW(ctx, -21); // Unsupported operation -- XT cannot be compiled.
+	return 0;
+}
+
+// Store the token T at HERE.
+void forth_TOKEN_COMMA(forth_runtime_context_t *ctx, forth_token_t t)
+{
+	forth_cell_t ix;
+	forth_cell_t dp;
+
+	if (0 == ctx->dictionary)
+	{
+		forth_THROW(ctx, -21); // Unsupported opration.
+	}
+
+	FORTH_CHECK_DICTIONARY_FROZEN(ctx);
+
+	ix = ctx->dictionary->dp;
+
+	if (0 != (ix & (sizeof(forth_token_t) - 1)))
+	{
+		forth_THROW(ctx, -23);	// Address alignment exception.
+	}
+
+	*(forth_token_t *)&(FORTH_DICTIONARY_ITEMS(ctx->dictionary)[ix]) = t;
+	dp = ix + sizeof(forth_token_t);
+
+	if (dp > ctx->dictionary->dp_max)
+	{
+		forth_THROW(ctx, -8); // Dictionary overflow.
+	}
+
+	ctx->dictionary->dp = dp;
+}
+#endif
+
+// Compile code that pushes X.
+void forth_LITERAL(forth_runtime_context_t *ctx, forth_cell_t x)
+{
+#if defined(FORTH_TOKEN_THREADED)
+	if ((forth_scell_t)x != (forth_stoken_t)x)
+	{
+		forth_COMPILE_COMMA(ctx, forth_WLIT_xt);
+		forth_TOKEN_COMMA(ctx, (forth_token_t)x);
+		forth_TOKEN_COMMA(ctx, (forth_token_t)(x >> 32));
+		return;
+	}
+#endif
+
+	forth_COMPILE_COMMA(ctx, forth_LIT_xt);
+	forth_TOKEN_COMMA(ctx, (forth_token_t)x);
+}
+
 // , ( u -- )
 void forth_comma(forth_runtime_context_t *ctx)
 {
@@ -3664,6 +4655,13 @@ void forth_comma(forth_runtime_context_t *ctx)
 	forth_COMMA(ctx, x);
 }
 
+// COMPILE, ( xt -- )
+void forth_compile_comma(forth_runtime_context_t *ctx)
+{
+	forth_cell_t xt = forth_POP(ctx);
+	forth_COMPILE_COMMA(ctx, xt);
+}
+
 // POSTPONE ( "name" -- )
 void forth_postpone(forth_runtime_context_t *ctx)
 {
@@ -3679,7 +4677,7 @@ void forth_postpone(forth_runtime_context_t *ctx)
 	else
 	{
 		forth_COMPILE_COMMA(ctx, forth_XLIT_xt);
-		forth_COMMA(ctx, (forth_cell_t)xt);
+		forth_TOKEN_COMMA(ctx, forth_XT_TO_TOKEN(ctx, xt));
 		forth_COMPILE_COMMA(ctx, forth_COMPILE_COMMA_xt);
 	}
 }
@@ -3689,7 +4687,7 @@ void forth_ahead(forth_runtime_context_t *ctx)
 {
 	forth_COMPILE_COMMA(ctx , forth_BRANCH_xt);
 	forth_here(ctx);
-	forth_COMMA(ctx, 0);
+	forth_TOKEN_COMMA(ctx, 0);
 	forth_PUSH(ctx, FORTH_ORIG_MARKER);
 }
 
@@ -3698,23 +4696,23 @@ void forth_if(forth_runtime_context_t *ctx)
 {
 	forth_COMPILE_COMMA(ctx , forth_0BRANCH_xt);
 	forth_here(ctx);
-	forth_COMMA(ctx, 0);
+	forth_TOKEN_COMMA(ctx, 0);
 	forth_PUSH(ctx, FORTH_ORIG_MARKER);
 }
 
 // THEN ( -- ) C: ( orig -- )
 void forth_then(forth_runtime_context_t *ctx)
 {
-	forth_cell_t *p;
+	forth_token_t *p;
 
 	if (FORTH_ORIG_MARKER != forth_POP(ctx))
 	{
 		forth_THROW(ctx, -22); // Control structure mismatch.
 	}
 
-	p = (forth_cell_t *)forth_POP(ctx);
+	p = (forth_token_t *)forth_POP(ctx);
 	forth_here(ctx);
-	*p = ((forth_cell_t *)forth_POP(ctx)) - p;
+	*p = (forth_token_t)(((forth_token_t *)forth_POP(ctx)) - p);
 }
 
 // ELSE ( -- ) C: ( orig1 -- orig2 )
@@ -3722,13 +4720,73 @@ void forth_else(forth_runtime_context_t *ctx)
 {
 	forth_COMPILE_COMMA(ctx , forth_BRANCH_xt);
 	forth_here(ctx);
-	forth_COMMA(ctx, 0);
+	forth_TOKEN_COMMA(ctx, 0);
 	forth_mrot(ctx);
 	forth_then(ctx);
 	forth_PUSH(ctx, FORTH_ORIG_MARKER);
 }
 #endif
 
+// Move >IN to the next word of the input source that starts with '[' and is as long as [IF], [ELSE] or [THEN],
+// counting the lines on the way the same way PARSE-NAME would. Return 0 if there is none (>IN is at the end).
+// Only the '['-s and the line ends have to be looked at, the rest of the input is skipped a cell at a time if possible.
+static int forth_SKIP_TO_BRACKET(forth_runtime_context_t *ctx)
+{
+	const char *start = ctx->source_address + ctx->to_in;
+	const char *end = ctx->source_address + ctx->source_length;
+	const char *p = start;
+	const char *q;
+	forth_cell_t lines = 0;
+	char c;
+
+	if (ctx->to_in >= ctx->source_length)
+	{
+		return 0;
+	}
+
+	while (p < end)
+	{
+#if defined(FORTH_SWAR_PARSING)
+		p += forth_SWAR_SCAN(p, (forth_cell_t)(end - p), '[');	// Stops at '[' and at the line ends.
+
+		if (p >= end)
+		{
+			break;
+		}
+#endif
+		c = *p;
+
+		if (('[' == c) && ((p == start) || isspace((int)(p[-1]))))
+		{
+			for (q = p + 1; (q < end) && !isspace((int)(*q)); q++)
+			{
+			}
+
+			if ((4 == (q - p)) || (6 == (q - p)))
+			{
+				ctx->to_in = (forth_cell_t)(p - ctx->source_address);
+				ctx->line_no += lines;
+				return 1;
+			}
+
+			p = q;
+			continue;
+		}
+
+		// A CR LF pair is a single line end.
+		if (('\n' == c) || ('\f' == c) || (('\r' == c) && (((p + 1) == end) || ('\n' != p[1]))))
+		{
+			lines++;
+		}
+
+		p++;
+	}
+
+	ctx->to_in = ctx->source_length;
+	ctx->line_no += lines;
+	return 0;
+}
+
 // Based on the reference implementation in the DPANS documents.
 // Added exception if refill fails.
 // [ELSE] ( -- )
@@ -3740,16 +4798,9 @@ void forth_bracket_else(forth_runtime_context_t *ctx)
 	
 	do
 	{
-		while(1)
+		while (forth_SKIP_TO_BRACKET(ctx))
 		{
-			forth_parse_name(ctx);
-			len = forth_POP(ctx);
-			str = (const char *)forth_POP(ctx);
-
-			if (0 == len)
-			{
-				break;
-			}
+			str = forth_PARSE_NAME(ctx, &len);
 
 			if (forth_COMPARE_NAMES("[IF]", str, len))
 			{
@@ -3842,8 +4893,8 @@ void forth_begin(forth_runtime_context_t *ctx)
 //  C: ( dest -- )
 void forth_BRANCH_TO_DEST(forth_runtime_context_t *ctx, forth_xt_t branch)
 {
-	forth_cell_t *dest;
-	forth_cell_t *here;
+	forth_token_t *dest;
+	forth_token_t *here;
 
 	if (FORTH_DEST_MARKER != forth_POP(ctx))
 	{
@@ -3851,10 +4902,10 @@ void forth_BRANCH_TO_DEST(forth_runtime_context_t *ctx, forth_xt_t branch)
 	}
 
 	forth_COMPILE_COMMA(ctx, branch);
-	dest = (forth_cell_t *)forth_POP(ctx);
+	dest = (forth_token_t *)forth_POP(ctx);
 	forth_here(ctx);
-	here = (forth_cell_t *)forth_POP(ctx);
-	forth_COMMA(ctx, (forth_cell_t)(dest - here));
+	here = (forth_token_t *)forth_POP(ctx);
+	forth_TOKEN_COMMA(ctx, (forth_token_t)(dest - here));
 }
 
 // AGAIN ( -- ) C: ( dest -- )
@@ -3889,7 +4940,11 @@ forth_vocabulary_entry_t *forth_CREATE_DICTIONARY_ENTRY(forth_runtime_context_t
 	forth_cell_t name_length;
 	forth_cell_t len;
 	forth_vocabulary_entry_t *res;
+#if defined(FORTH_SEPARATE_HEADS)
+	forth_cell_t *head;
+#else
 	uint8_t *here;
+#endif
 
 	if (0 == ctx->dictionary)
 	{
@@ -3913,10 +4968,43 @@ forth_vocabulary_entry_t *forth_CREATE_DICTIONARY_ENTRY(forth_runtime_context_t
 	name = (const char *)forth_POP(ctx);
 	len = name_length + 1;
 
+#if defined(FORTH_COMPACT_HEADERS)
+	if (FORTH_COMPACT_NAME_MAX_LENGTH < name_length)
+	{
+		forth_THROW(ctx, -19); // Definition name too long.
+	}
+
+	forth_align(ctx);	// The name ends right before the header, see FORTH_ENTRY_NAME().
+#endif
+
+#if defined(FORTH_SEPARATE_HEADS)
+	// The head (link and name) is taken from the end of the dictionary, only the flags are laid down at HERE.
+	forth_align(ctx);
+	len = sizeof(forth_cell_t) + FORTH_ALIGN(len);
+
+	if ((len + sizeof(forth_cell_t)) > (ctx->dictionary->dp_max - ctx->dictionary->dp))
+	{
+		forth_THROW(ctx, -8); // Dictionary overflow.
+	}
+
+	ctx->dictionary->dp_max -= len;
+	head = (forth_cell_t *)(FORTH_DICTIONARY_ITEMS(ctx->dictionary) + ctx->dictionary->dp_max);
+	memmove(head + 1, name, name_length);
+	((char *)(head + 1))[name_length] = 0;
+	forth_here(ctx);
+	res = FORTH_HEADER_XT(forth_POP(ctx));
+	forth_COMMA(ctx, FORTH_XT_FLAGS_COMPACT | ((forth_cell_t)(head - (forth_cell_t *)res) << 8));	// flags and the head
+	forth_SET_LINK(ctx, res, forth_GET_LATEST(ctx));								// link
+#else
+#if defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+	// The header and (at least the beginning of) the body should be in the same segment.
+	forth_ROOM(ctx, FORTH_ALIGN(len) + sizeof(forth_vocabulary_entry_t) + FORTH_SEGMENT_DEFINITION_ROOM);
+#else
 	if ((sizeof(forth_vocabulary_entry_t) + len) > (ctx->dictionary->dp_max - ctx->dictionary->dp))
 	{
 		forth_THROW(ctx, -8); // Dictionary overflow.
 	}
+#endif
 
 	forth_here(ctx);
 	here = (uint8_t *)forth_POP(ctx);
@@ -3926,10 +5014,16 @@ forth_vocabulary_entry_t *forth_CREATE_DICTIONARY_ENTRY(forth_runtime_context_t
 	here[name_length] = 0;
 	forth_align(ctx);
 	forth_here(ctx);
-	res = (forth_vocabulary_entry_t *)forth_POP(ctx);
+	res = FORTH_HEADER_XT(forth_POP(ctx));
+#if defined(FORTH_COMPACT_HEADERS)
+	forth_COMMA(ctx, FORTH_XT_FLAGS_COMPACT | (name_length << 8));	// flags and the length of the name
+	forth_SET_LINK(ctx, res, forth_GET_LATEST(ctx));				// link
+#else
 	forth_COMMA(ctx, (forth_cell_t)here);							// name
 	forth_COMMA(ctx, 0);											// flags
 	forth_COMMA(ctx, (forth_cell_t)forth_GET_LATEST(ctx));			// link
+#endif
+#endif
 
 	return res;
 }
@@ -3937,25 +5031,24 @@ forth_vocabulary_entry_t *forth_CREATE_DICTIONARY_ENTRY(forth_runtime_context_t
 // LITERAL Compile: ( x -- ) Run: ( -- x ) 
 void forth_literal(forth_runtime_context_t *ctx)
 {
-	forth_COMPILE_COMMA(ctx, forth_LIT_xt);
-	forth_comma(ctx);
+	forth_cell_t x = forth_POP(ctx);
+	forth_LITERAL(ctx, x);
 }
 
 // XLITERAL Compile: ( xt -- ) Run: ( -- xt ) 
 void forth_xliteral(forth_runtime_context_t *ctx)
 {
+	forth_xt_t xt = (forth_xt_t)forth_POP(ctx);
 	forth_COMPILE_COMMA(ctx, forth_XLIT_xt);
-	forth_comma(ctx);
+	forth_TOKEN_COMMA(ctx, forth_XT_TO_TOKEN(ctx, xt));
 }
 
 // 2LITERAL Compile: ( x y -- ) Run: ( -- x y ) 
 void forth_2literal(forth_runtime_context_t *ctx)
 {
 	forth_swap(ctx);
-	forth_COMPILE_COMMA(ctx, forth_LIT_xt);
-	forth_comma(ctx);
-	forth_COMPILE_COMMA(ctx, forth_LIT_xt);
-	forth_comma(ctx);
+	forth_literal(ctx);
+	forth_literal(ctx);
 }
 
 // meaning@ ( xt -- meaning ) // Used for things like DEFER@
@@ -4010,7 +5103,7 @@ void forth_to_runtime(forth_runtime_context_t *ctx)
 		forth_THROW(ctx, -21); // Unsupported operation.
 	}
 
-	forth_PUSH(ctx, (forth_cell_t)(ctx->ip[0]));
+	forth_PUSH(ctx, (forth_cell_t)forth_TOKEN_TO_XT(ctx, ctx->ip[0]));
 	forth_assign_to(ctx);
 	ctx->ip++;
 }
@@ -4070,7 +5163,7 @@ void forth_to(forth_runtime_context_t *ctx)
 	else
 	{
 		forth_COMPILE_COMMA(ctx, forth_TO_RT_xt);
-		forth_COMPILE_COMMA(ctx, xt);
+		forth_TOKEN_COMMA(ctx, forth_XT_TO_TOKEN(ctx, xt));
 	}
 }
 
@@ -4092,10 +5185,10 @@ void forth_defer(forth_runtime_context_t *ctx)
 	forth_vocabulary_entry_t *entry;
 
 	entry = forth_PARSE_NAME_AND_CREATE_ENTRY(ctx);
-	entry->flags = FORTH_XT_FLAGS_ACTION_DEFER;
+	FORTH_SET_XT_FLAGS(entry, FORTH_XT_FLAGS_ACTION_DEFER);
 	//entry->meaning = value;
 	forth_COMMA(ctx, 0); // Meaning.
-	entry->link = (forth_cell_t)forth_GET_LATEST(ctx);
+	forth_SET_LINK(ctx, entry, forth_GET_LATEST(ctx));
 	forth_SET_LATEST(ctx, entry);
 }
 
@@ -4105,9 +5198,9 @@ void forth_variable(forth_runtime_context_t *ctx)
 	forth_vocabulary_entry_t *entry;
 
 	entry = forth_PARSE_NAME_AND_CREATE_ENTRY(ctx);
-	entry->flags = FORTH_XT_FLAGS_ACTION_VARIABLE;
+	FORTH_SET_XT_FLAGS(entry, FORTH_XT_FLAGS_ACTION_VARIABLE);
 	forth_COMMA(ctx, 0); // Meaning.
-	entry->link = (forth_cell_t)forth_GET_LATEST(ctx);
+	forth_SET_LINK(ctx, entry, forth_GET_LATEST(ctx));
 	forth_SET_LATEST(ctx, entry);
 }
 
@@ -4117,10 +5210,10 @@ void forth_2variable(forth_runtime_context_t *ctx)
 	forth_vocabulary_entry_t *entry;
 
 	entry = forth_PARSE_NAME_AND_CREATE_ENTRY(ctx);
-	entry->flags = FORTH_XT_FLAGS_ACTION_2VARIABLE;
+	FORTH_SET_XT_FLAGS(entry, FORTH_XT_FLAGS_ACTION_2VARIABLE);
 	forth_COMMA(ctx, 0); // Meaning.
 	forth_COMMA(ctx, 0); 
-	entry->link = (forth_cell_t)forth_GET_LATEST(ctx);
+	forth_SET_LINK(ctx, entry, forth_GET_LATEST(ctx));
 	forth_SET_LATEST(ctx, entry);
 }
 
@@ -4131,10 +5224,10 @@ void forth_constant(forth_runtime_context_t *ctx)
 	forth_cell_t value = forth_POP(ctx);
 
 	entry = forth_PARSE_NAME_AND_CREATE_ENTRY(ctx);
-	entry->flags = FORTH_XT_FLAGS_ACTION_CONSTANT;
+	FORTH_SET_XT_FLAGS(entry, FORTH_XT_FLAGS_ACTION_CONSTANT);
 	//entry->meaning = value;
 	forth_COMMA(ctx, value); // Meaning.
-	entry->link = (forth_cell_t)forth_GET_LATEST(ctx);
+	forth_SET_LINK(ctx, entry, forth_GET_LATEST(ctx));
 	forth_SET_LATEST(ctx, entry);
 }
 
@@ -4146,10 +5239,10 @@ void forth_2constant(forth_runtime_context_t *ctx)
 	forth_cell_t value_l = forth_POP(ctx);
 
 	entry = forth_PARSE_NAME_AND_CREATE_ENTRY(ctx);
-	entry->flags = FORTH_XT_FLAGS_ACTION_2CONSTANT;
+	FORTH_SET_XT_FLAGS(entry, FORTH_XT_FLAGS_ACTION_2CONSTANT);
 	forth_COMMA(ctx, value_h); // Meaning.
 	forth_COMMA(ctx, value_l); 
-	entry->link = (forth_cell_t)forth_GET_LATEST(ctx);
+	forth_SET_LINK(ctx, entry, forth_GET_LATEST(ctx));
 	forth_SET_LATEST(ctx, entry);
 }
 
@@ -4160,9 +5253,9 @@ void forth_value(forth_runtime_context_t *ctx)
 	forth_cell_t value = forth_POP(ctx);
 
 	entry = forth_PARSE_NAME_AND_CREATE_ENTRY(ctx);
-	entry->flags = FORTH_XT_FLAGS_ACTION_VALUE;
+	FORTH_SET_XT_FLAGS(entry, FORTH_XT_FLAGS_ACTION_VALUE);
 	forth_COMMA(ctx, value); // Meaning.
-	entry->link = (forth_cell_t)forth_GET_LATEST(ctx);
+	forth_SET_LINK(ctx, entry, forth_GET_LATEST(ctx));
 	forth_SET_LATEST(ctx, entry);
 }
 
@@ -4174,10 +5267,10 @@ void forth_2value(forth_runtime_context_t *ctx)
 	forth_cell_t value_l = forth_POP(ctx);
 
 	entry = forth_PARSE_NAME_AND_CREATE_ENTRY(ctx);
-	entry->flags = FORTH_XT_FLAGS_ACTION_2VALUE;
+	FORTH_SET_XT_FLAGS(entry, FORTH_XT_FLAGS_ACTION_2VALUE);
 	forth_COMMA(ctx, value_h); // Meaning.
 	forth_COMMA(ctx, value_l); 
-	entry->link = (forth_cell_t)forth_GET_LATEST(ctx);
+	forth_SET_LINK(ctx, entry, forth_GET_LATEST(ctx));
 	forth_SET_LATEST(ctx, entry);
 }
 
@@ -4191,14 +5284,36 @@ void forth_colon(forth_runtime_context_t *ctx)
 #endif
 
 	entry = forth_PARSE_NAME_AND_CREATE_ENTRY(ctx);
-	entry->flags = FORTH_XT_FLAGS_ACTION_THREADED;
+	FORTH_SET_XT_FLAGS(entry, FORTH_XT_FLAGS_ACTION_THREADED);
 	forth_PUSH(ctx, (forth_cell_t)entry);
 	ctx->defining = ctx->sp[0];
 	forth_PUSH(ctx, FORTH_COLON_SYS_MARKER);
 	forth_right_bracket(ctx);
 }
 
+#if !defined(FORTH_ONE_CELL_HEADERS)
 static const char *nameless = "";
+#endif
+
+// Lay down the header of a nameless threaded definition (not linked to any word list), return its xt.
+forth_vocabulary_entry_t *forth_NAMELESS_HEADER(forth_runtime_context_t *ctx)
+{
+	forth_vocabulary_entry_t *entry;
+
+	forth_align(ctx);
+	forth_here(ctx);
+	entry = FORTH_HEADER_XT(forth_POP(ctx));
+#if defined(FORTH_ONE_CELL_HEADERS)
+	forth_COMMA(ctx, FORTH_XT_FLAGS_COMPACT | FORTH_XT_FLAGS_ACTION_THREADED);
+#else
+	forth_COMMA(ctx, (forth_cell_t)nameless);
+	forth_COMMA(ctx, FORTH_XT_FLAGS_ACTION_THREADED);	// flags
+	forth_COMMA(ctx, 0);								// link (not linked).
+#endif
+
+	return entry;
+}
+
 // :NONAME ( -- xt colon-sys )
 void forth_colon_noname(forth_runtime_context_t *ctx)
 {
@@ -4206,11 +5321,10 @@ void forth_colon_noname(forth_runtime_context_t *ctx)
 	ctx->dictionary->local_count = 0;
 #endif
 
-	forth_align(ctx);
-	forth_here(ctx);	// xt
-	forth_COMMA(ctx, (forth_cell_t)nameless);
-	forth_COMMA(ctx, FORTH_XT_FLAGS_ACTION_THREADED);	// flags
-	forth_COMMA(ctx, 0);								// link (not linked).
+#if defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+	forth_ROOM(ctx, sizeof(forth_vocabulary_entry_t) + FORTH_SEGMENT_DEFINITION_ROOM);
+#endif
+	forth_PUSH(ctx, (forth_cell_t)forth_NAMELESS_HEADER(ctx));	// xt
 	forth_dup(ctx);
 	ctx->defining = ctx->sp[0];
 	forth_PUSH(ctx, FORTH_COLON_SYS_MARKER);
@@ -4233,11 +5347,14 @@ void forth_semicolon(forth_runtime_context_t *ctx)
 	}
 
 	forth_COMPILE_COMMA(ctx, 0);
+#if defined(FORTH_TOKEN_THREADED)
+	forth_align(ctx);
+#endif
 	entry = (forth_vocabulary_entry_t *)forth_POP(ctx);
 
-	if ((0 != entry->name) && (0 != *((const char *)(entry->name)))) // Checking for noname entries.
+	if ((0 != FORTH_ENTRY_NAME(entry)) && (0 != *FORTH_ENTRY_NAME(entry))) // Checking for noname entries.
 	{
-		entry->link = (forth_cell_t)forth_GET_LATEST(ctx);
+		forth_SET_LINK(ctx, entry, forth_GET_LATEST(ctx));
 		forth_SET_LATEST(ctx, entry);
 	}
 
@@ -4289,18 +5406,50 @@ void forth_SET_LATEST(forth_runtime_context_t *ctx, forth_vocabulary_entry_t *to
 	}
 
 	((forth_wordlist_t *)(ctx->current))->latest = (forth_cell_t)token;
+	FORTH_NAMES_CHANGED(ctx);
 	//ctx->dictionary->latest = (forth_cell_t)token;
 	//ctx->dictionary->forth_wl.latest = (forth_cell_t)token;
 }
 
-// LATEST ( -- addr )
-void forth_latest(forth_runtime_context_t *ctx)
+#if defined(FORTH_COMPACT_HEADERS)
+// Link ENTRY to LINK (the previous entry of its word list), which must be at most FORTH_COMPACT_LINK_MAX cells before it.
+void forth_SET_LINK(forth_runtime_context_t *ctx, forth_vocabulary_entry_t *entry, const forth_vocabulary_entry_t *link)
 {
-	forth_PUSH(ctx, (forth_cell_t)forth_GET_LATEST(ctx));
-}
+	forth_cell_t distance = 0;
 
-// RECURSE ( -- )
-void forth_recurse(forth_runtime_context_t *ctx)
+	if (0 != link)
+	{
+		distance = (forth_cell_t)(((const forth_cell_t *)entry) - ((const forth_cell_t *)link));
+
+		if ((link >= entry) || (FORTH_COMPACT_LINK_MAX < distance))
+		{
+			forth_THROW(ctx, -21); // Unsupported operation -- the previous word is out of the reach of the link.
+		}
+	}
+
+	entry->flags = (entry->flags & ((FORTH_COMPACT_NAME_MAX_LENGTH << 8) | FORTH_XT_FLAGS_MASK)) | (distance << 16);
+}
+#elif defined(FORTH_SEPARATE_HEADS)
+// Link ENTRY to LINK (the previous entry of its word list), the link is kept in the head of ENTRY.
+void forth_SET_LINK(forth_runtime_context_t *ctx, forth_vocabulary_entry_t *entry, const forth_vocabulary_entry_t *link)
+{
+	if (0 == (entry->flags >> 8))
+	{
+		forth_THROW(ctx, -21); // Unsupported operation -- a nameless definition has no head.
+	}
+
+	FORTH_HEAD(entry)[0] = (forth_cell_t)link;
+}
+#endif
+
+// LATEST ( -- addr )
+void forth_latest(forth_runtime_context_t *ctx)
+{
+	forth_PUSH(ctx, (forth_cell_t)forth_GET_LATEST(ctx));
+}
+
+// RECURSE ( -- )
+void forth_recurse(forth_runtime_context_t *ctx)
 {
 	forth_cell_t xt = ctx->defining;
 
@@ -4318,9 +5467,9 @@ void forth_create(forth_runtime_context_t *ctx)
 	forth_vocabulary_entry_t *entry;
 
 	entry = forth_PARSE_NAME_AND_CREATE_ENTRY(ctx);
-	entry->flags = FORTH_XT_FLAGS_ACTION_CREATE;
+	FORTH_SET_XT_FLAGS(entry, FORTH_XT_FLAGS_ACTION_CREATE);
 	forth_COMMA(ctx, 0); // Meaning.
-	entry->link = (forth_cell_t)forth_GET_LATEST(ctx);
+	forth_SET_LINK(ctx, entry, forth_GET_LATEST(ctx));
 	forth_SET_LATEST(ctx, entry);
 }
 
@@ -4341,7 +5490,7 @@ void forth_to_body(forth_runtime_context_t *ctx)
 void forth_p_does(forth_runtime_context_t *ctx)
 {
 	forth_vocabulary_entry_t *entry = forth_GET_LATEST(ctx);
-	entry->meaning = (forth_cell_t)&(ctx->ip[1]);
+	entry->meaning = (forth_cell_t)FORTH_HEADER_XT(FORTH_ALIGN(&(ctx->ip[1])));	// The code after DOES> (see forth_colon_noname()).
 }
 
 // DOES> C:( colon-sys1 -- colon-sys2 )
@@ -4352,6 +5501,10 @@ void forth_does(forth_runtime_context_t *ctx)
 		forth_THROW(ctx, -14); // interpreting a compile-only word
 	}
 
+#if defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+	// (does>), the end of the definition and the header of the code after DOES> must be in the same segment.
+	forth_ROOM(ctx, (2 * sizeof(forth_cell_t)) + sizeof(forth_vocabulary_entry_t) + FORTH_SEGMENT_DEFINITION_ROOM);
+#endif
 	forth_COMPILE_COMMA(ctx, forth_pDOES_xt); // (does>)
 	forth_semicolon(ctx);
 	forth_colon_noname(ctx);
@@ -4361,7 +5514,7 @@ void forth_does(forth_runtime_context_t *ctx)
 // ---------------------------------------------------------------------------------------------------------------
 void forth_PRINT_NAME(forth_runtime_context_t *ctx, forth_xt_t xt)
 {
-		if ((0 == xt->name) || (0 == strlen((const char *)xt->name)))
+		if ((0 == FORTH_ENTRY_NAME(xt)) || (0 == strlen(FORTH_ENTRY_NAME(xt))))
 		{
 			forth_TYPE0(ctx, "NONAME-XT-");
 			forth_PUSH(ctx, (forth_cell_t)xt);
@@ -4369,7 +5522,7 @@ void forth_PRINT_NAME(forth_runtime_context_t *ctx, forth_xt_t xt)
 		}
 		else
 		{
-			forth_TYPE0(ctx, (const char *)(xt->name));
+			forth_TYPE0(ctx, FORTH_ENTRY_NAME(xt));
 			forth_space(ctx);
 		}
 }
@@ -4377,12 +5530,12 @@ void forth_PRINT_NAME(forth_runtime_context_t *ctx, forth_xt_t xt)
 #if !defined(FORTH_WITHOUT_COMPILATION)
 void forth_SEE_THREADED(forth_runtime_context_t *ctx, forth_xt_t xt)
 {
-	forth_cell_t *ip;
+	forth_token_t *ip;
 	forth_xt_t x;
 	forth_cell_t len;
 	forth_cell_t tmp;
 
-	if ((0 == xt->name) || (0 == strlen((const char *)xt->name)))
+	if ((0 == FORTH_ENTRY_NAME(xt)) || (0 == strlen(FORTH_ENTRY_NAME(xt))))
 	{
 		forth_TYPE0(ctx, ":noname ");
 	}
@@ -4392,20 +5545,28 @@ void forth_SEE_THREADED(forth_runtime_context_t *ctx, forth_xt_t xt)
 		forth_PRINT_NAME(ctx, xt);
 	}
 
-	for (ip = &(xt->meaning); 0 != *ip; ip++)
+	for (ip = (forth_token_t *)&(xt->meaning); 0 != *ip; ip++)
 	{
-		x = *((forth_xt_t *)ip);
+		x = forth_TOKEN_TO_XT(ctx, *ip);
 
 		if (forth_LIT_xt == x)
 		{
-			forth_PUSH(ctx, *++ip);
+			forth_PUSH(ctx, (forth_cell_t)(forth_stoken_t)*++ip);
+			forth_dot(ctx);
+		}
+#if defined(FORTH_TOKEN_THREADED)
+		else if (forth_WLIT_xt == x)
+		{
+			forth_PUSH(ctx, ((forth_cell_t)(ip[1])) | (((forth_cell_t)(ip[2])) << 32));
 			forth_dot(ctx);
+			ip += 2;
 		}
+#endif
 		else if (forth_XLIT_xt == x)
 		{
 			forth_TYPE0(ctx, " ['] ");
 			ip++;
-			x = *((forth_xt_t *)ip);
+			x = forth_TOKEN_TO_XT(ctx, *ip);
 			forth_PRINT_NAME(ctx, x);
 		}
 		else if (forth_SLIT_xt == x)
@@ -4416,16 +5577,21 @@ void forth_SEE_THREADED(forth_runtime_context_t *ctx, forth_xt_t xt)
 			forth_TYPE0(ctx, "s\" ");
 			forth_type(ctx);
 			forth_TYPE0(ctx, "\" ");
-			tmp = ((forth_cell_t)(ip + 1)) + len; // Only + 1 (not 2) because the for() auto increments ip.
-			tmp = FORTH_ALIGN(tmp);
-			ip = (forth_cell_t *)tmp;
+			tmp = FORTH_ALIGN(((forth_cell_t)(ip + 2)) + len);
+			ip = ((forth_token_t *)tmp) - 1; // Because the for() auto increments ip.
+		}
+#if defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+		else if (forth_SEGMENT_BRANCH_xt == x)
+		{
+			ip += (forth_stoken_t)(ip[1]);	// Just follow the code into the next segment.
 		}
+#endif
 		else if ((forth_BRANCH_xt == x) || (forth_0BRANCH_xt == x))
 		{
-			tmp = ip[1];
+			tmp = (forth_cell_t)(forth_stoken_t)(ip[1]);
 			ip += 1;
 			forth_TYPE0(ctx, " [ ' ");
-			forth_TYPE0(ctx, (const char *)x->name);
+			forth_TYPE0(ctx, FORTH_ENTRY_NAME(x));
 			forth_TYPE0(ctx, " COMPILE, ");
 			forth_PUSH(ctx, tmp);
 			forth_dot(ctx);
@@ -4445,6 +5611,14 @@ void forth_SEE_THREADED(forth_runtime_context_t *ctx, forth_xt_t xt)
 		else if (forth_pLOOP_xt == x)
 		{
 			ip += 1;
+#if defined(FORTH_INCLUDE_THREADS)
+			if (forth_pPAR_LOOP_xt == forth_TOKEN_TO_XT(ctx, ip[1]))
+			{
+				ip += 1;
+				forth_TYPE0(ctx, "par-loop ");
+				continue;
+			}
+#endif
 			forth_TYPE0(ctx, "loop ");
 		}
 		else if (forth_ppLOOP_xt == x)
@@ -4454,9 +5628,18 @@ void forth_SEE_THREADED(forth_runtime_context_t *ctx, forth_xt_t xt)
 		}
 		else if (forth_pDOES_xt == x)
 		{
-			ip+= 4;	// sizeof(forth_vocabulary_entry_struct) in cells.
+			// Skip the end of the definition and the header of the code after DOES> (see forth_colon_noname()).
+			ip = ((forth_token_t *)FORTH_ALIGN(ip + 2)) + ((FORTH_HEADER_CELLS * sizeof(forth_cell_t)) / sizeof(forth_token_t)) - 1;
 			forth_TYPE0(ctx, "does> ");
 		}
+#if defined(FORTH_INCLUDE_THREADS)
+		else if (forth_pPAR_DO_xt == x)
+		{
+			// The offset, the header of the loop xt, (?DO) and its offset.
+			ip = ((forth_token_t *)FORTH_ALIGN(ip + 2)) + ((FORTH_HEADER_CELLS * sizeof(forth_cell_t)) / sizeof(forth_token_t)) + 1;
+			forth_TYPE0(ctx, "par-do ");
+		}
+#endif
 		else
 		{
 			forth_PRINT_NAME(ctx, x);
@@ -4474,7 +5657,7 @@ void forth_SEE_THREADED(forth_runtime_context_t *ctx, forth_xt_t xt)
 	forth_cell_t len;
 	forth_cell_t tmp;
 
-	if ((0 == xt->name) || (0 == strlen((const char *)xt->name)))
+	if ((0 == FORTH_ENTRY_NAME(xt)) || (0 == strlen(FORTH_ENTRY_NAME(xt))))
 	{
 		forth_TYPE0(ctx, ":noname ");
 	}
@@ -4499,7 +5682,7 @@ void forth_SEE(forth_runtime_context_t *ctx, forth_xt_t xt)
 	switch(xt->flags & FORTH_XT_FLAGS_ACTION_MASK)
 	{
 		case FORTH_XT_FLAGS_ACTION_PRIMITIVE:
-			forth_TYPE0(ctx, (const char *)(xt->name));
+			forth_TYPE0(ctx, FORTH_ENTRY_NAME(xt));
 			forth_TYPE0(ctx, " is a primitive.");
 			break;
 
@@ -4507,7 +5690,7 @@ void forth_SEE(forth_runtime_context_t *ctx, forth_xt_t xt)
 			forth_PUSH(ctx, xt->meaning);
 			forth_hdot(ctx);
 			forth_TYPE0(ctx, "CONSTANT ");
-			forth_TYPE0(ctx, (const char *)(xt->name));
+			forth_TYPE0(ctx, FORTH_ENTRY_NAME(xt));
 			break;
 
 		case FORTH_XT_FLAGS_ACTION_2CONSTANT:
@@ -4516,14 +5699,14 @@ void forth_SEE(forth_runtime_context_t *ctx, forth_xt_t xt)
 			forth_PUSH(ctx, xt->meaning);
 			forth_hdot(ctx);
 			forth_TYPE0(ctx, "2CONSTANT ");
-			forth_TYPE0(ctx, (const char *)(xt->name));
+			forth_TYPE0(ctx, FORTH_ENTRY_NAME(xt));
 			break;
 
 		case FORTH_XT_FLAGS_ACTION_VALUE:
 			forth_PUSH(ctx, xt->meaning);
 			forth_hdot(ctx);
 			forth_TYPE0(ctx, "VALUE ");
-			forth_TYPE0(ctx, (const char *)(xt->name));
+			forth_TYPE0(ctx, FORTH_ENTRY_NAME(xt));
 			break;
 
 		case FORTH_XT_FLAGS_ACTION_2VALUE:
@@ -4532,22 +5715,22 @@ void forth_SEE(forth_runtime_context_t *ctx, forth_xt_t xt)
 			forth_PUSH(ctx, xt->meaning);
 			forth_hdot(ctx);
 			forth_TYPE0(ctx, "2VALUE ");
-			forth_TYPE0(ctx, (const char *)(xt->name));
+			forth_TYPE0(ctx, FORTH_ENTRY_NAME(xt));
 			break;
 
 		case FORTH_XT_FLAGS_ACTION_VARIABLE:
 			forth_TYPE0(ctx, "VARIABLE ");
-			forth_TYPE0(ctx, (const char *)(xt->name));
+			forth_TYPE0(ctx, FORTH_ENTRY_NAME(xt));
 			break;
 
 		case FORTH_XT_FLAGS_ACTION_2VARIABLE:
 			forth_TYPE0(ctx, "2VARIABLE ");
-			forth_TYPE0(ctx, (const char *)(xt->name));
+			forth_TYPE0(ctx, FORTH_ENTRY_NAME(xt));
 			break;
 
 		case FORTH_XT_FLAGS_ACTION_CREATE:
 			forth_TYPE0(ctx, "CREATE ");
-			forth_TYPE0(ctx, (const char *)(xt->name));
+			forth_TYPE0(ctx, FORTH_ENTRY_NAME(xt));
 			if (0 != xt->meaning)
 			{
 				forth_TYPE0(ctx, " ... DOES> ");
@@ -4557,7 +5740,7 @@ void forth_SEE(forth_runtime_context_t *ctx, forth_xt_t xt)
 
 		case FORTH_XT_FLAGS_ACTION_DEFER:
 			forth_TYPE0(ctx, "DEFER ");
-			forth_TYPE0(ctx, (const char *)(xt->name));
+			forth_TYPE0(ctx, FORTH_ENTRY_NAME(xt));
 			break;
 
 		case FORTH_XT_FLAGS_ACTION_THREADED:
@@ -4565,7 +5748,7 @@ void forth_SEE(forth_runtime_context_t *ctx, forth_xt_t xt)
 			break;
 
 		default:
-			forth_TYPE0(ctx, (const char *)(xt->name));
+			forth_TYPE0(ctx, FORTH_ENTRY_NAME(xt));
 			forth_TYPE0(ctx, " ?????");
 			break;
 	}
@@ -4607,14 +5790,6 @@ void forth_bracket_undefined(forth_runtime_context_t *ctx)
 void forth_tick(forth_runtime_context_t *ctx)
 {
     forth_parse_name(ctx);
-
-	ctx->symbol_addr = ctx->sp[1];
-	ctx->symbol_length = ctx->sp[0];
-	ctx->symbol_line = ctx->line_no;
-	ctx->symbol_source_id = ctx->source_id;
-	ctx->symbol_blk = ctx->blk;
-	ctx->symbol_position = ctx->to_in;
-
     forth_find_name(ctx);
 
     if (0 == ctx->sp[0])
@@ -4775,6 +5950,7 @@ DEF_FORTH_WORD("emit",       0, forth_emit,          "( char -- )"),
 DEF_FORTH_WORD("cr",         0, forth_cr,            "( -- )"),
 DEF_FORTH_WORD("page",       0, forth_page,          "( -- )"),
 DEF_FORTH_WORD("at-xy",      0, forth_at_xy,         "( x y -- )"),
+DEF_FORTH_WORD("flush-output", 0, forth_flush_output, "( -- )"),
 
 DEF_FORTH_WORD(".",          0, forth_dot,           "( x -- )"),
 DEF_FORTH_WORD("h.",         0, forth_hdot,          "( x -- )"),
@@ -4953,9 +6129,9 @@ DEF_FORTH_WORD("over",       0, forth_over,          "( x y -- x y x )"),					//
 DEF_FORTH_WORD("=",          0, forth_equals,        "( x y -- flag )"),					//  3
 DEF_FORTH_WORD("type",       0, forth_type,          "( addr count -- )"),					//  4
 #if !defined(FORTH_WITHOUT_COMPILATION)
-DEF_FORTH_WORD("compile,",   0, forth_comma,         "( xt --  )"),							//  5
+DEF_FORTH_WORD("compile,",   0, forth_compile_comma, "( xt --  )"),							//  5
 DEF_FORTH_WORD("LIT",        0, forth_lit,           "( -- n )" ),							//  6
-DEF_FORTH_WORD("XLIT",       0, forth_lit,           "( -- n )" ),							//  7
+DEF_FORTH_WORD("XLIT",       0, forth_xlit,          "( -- xt )" ),							//  7
 DEF_FORTH_WORD("SLIT",       0, forth_slit,          "( -- c-addr len )" ),					//  8
 DEF_FORTH_WORD("BRANCH",	 0, forth_branch,		 " ( -- )"),							//  9
 DEF_FORTH_WORD("0BRANCH",	 0, forth_0branch,		 " ( flag -- )"),						// 10
@@ -4967,6 +6143,9 @@ DEF_FORTH_WORD("(does>)",    0, forth_p_does,        "( -- )"),								// 15
 DEF_FORTH_WORD("(abort\")",  0, forth_pabortq,       "( f c-addr len -- )"),				// 16
 DEF_FORTH_WORD( "(do-voc)",	 0, forth_do_voc,	 	 "( addr -- )"),						// 17
 DEF_FORTH_WORD( "(to)",		 0, forth_to_runtime,	 "( ?*x  -- )"),						// 18
+#if defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+DEF_FORTH_WORD("(SEGMENT-BRANCH)", 0, forth_branch,	 " ( -- )"),							// 19
+#endif
 #endif
 DEF_FORTH_WORD(0, 0, 0, 0)
 };
@@ -4993,6 +6172,24 @@ const forth_xt_t forth_pDOES_xt				= (const forth_xt_t)&(forth_wl_system[15]);
 const forth_xt_t forth_pABORTq_xt			= (const forth_xt_t)&(forth_wl_system[16]);
 const forth_xt_t forth_DO_VOC_xt			= (const forth_xt_t)&(forth_wl_system[17]);
 const forth_xt_t forth_TO_RT_xt				= (const forth_xt_t)&(forth_wl_system[18]);
+#if defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+const forth_xt_t forth_SEGMENT_BRANCH_xt	= (const forth_xt_t)&(forth_wl_system[19]);
+#endif
+#endif
+
+#if defined(FORTH_TOKEN_THREADED)
+// Words that only exist in token threaded code, they are not in any word list.
+const forth_vocabulary_entry_t forth_wl_token_support[] =
+{
+#if !defined(FORTH_WITHOUT_COMPILATION)
+DEF_FORTH_WORD("WLIT",       0, forth_wlit,          "( -- x )" ),							//  0
+#endif
+DEF_FORTH_WORD(0, 0, 0, 0)
+};
+
+#if !defined(FORTH_WITHOUT_COMPILATION)
+const forth_xt_t forth_WLIT_xt				= (const forth_xt_t)&(forth_wl_token_support[0]);
+#endif
 #endif
 // -----------------------------------------------------------------------------------------------
 // Get the size of the Forth runtime context structure.
@@ -5002,18 +6199,25 @@ forth_cell_t Forth_GetContextSize(void)
 	return (forth_cell_t)sizeof(forth_runtime_context_t);
 }
 
+forth_cell_t Forth_GetColdContextSize(void)
+{
+	return (forth_cell_t)sizeof(forth_cold_context_t);
+}
+
 // Initialize the Forth runtime context structure.
 forth_scell_t Forth_InitContext(forth_runtime_context_t *ctx, const forth_context_init_data_t *init_data)
 {
 	int res;
 
-	if ((0 == ctx) || (0 == init_data->data_stack) || (0 == init_data->return_stack) ||
+	if ((0 == ctx) || (0 == init_data->data_stack) || (0 == init_data->return_stack) || (0 == init_data->cold) ||
 	    (8 > init_data->data_stack_cell_count) || (8 > init_data->return_stack_cell_count))
 	{
 		return -1;
 	}
 
 	memset(ctx, 0, sizeof(forth_runtime_context_t));
+	ctx->cold = init_data->cold;
+	ctx->cold->input_buffers = 1;
 
 	ctx->base = 10;			// Set base to decimal.
 	ctx->ip = 0;
@@ -5027,7 +6231,7 @@ forth_scell_t Forth_InitContext(forth_runtime_context_t *ctx, const forth_contex
 	ctx->rp0    = ctx->rp_max;
 	ctx->rp     = ctx->rp_max;
 
-	forth_less_hash(ctx);	// Initialize the number formatting buffer so accidentally typed in HOLD, etc. does not crash.
+	(void)Forth_ResetContext(ctx);	// This also initializes the number formatting buffer so accidentally typed in HOLD, etc. does not crash.
 
 #if !defined(FORTH_WITHOUT_COMPILATION)
 	ctx->dictionary = init_data->dictionary;
@@ -5042,6 +6246,168 @@ forth_scell_t Forth_InitContext(forth_runtime_context_t *ctx, const forth_contex
 	return 0;
 }
 
+// Make CTX ready to run a new script: empty stacks, interpreting, no input source, no pending error information.
+// The dictionary, the search order, BASE and the devices are kept.
+// This is cheaper than Forth_InitContext(), so contexts can be pooled and reused.
+forth_scell_t Forth_ResetContext(forth_runtime_context_t *ctx)
+{
+	if ((0 == ctx) || (0 == ctx->sp0) || (0 == ctx->rp0) || (0 == ctx->cold))
+	{
+		return -9; // Invalid memory address, is there anything better here?
+	}
+
+	ctx->sp = ctx->sp0;
+	ctx->rp = ctx->rp0;
+	ctx->ip = 0;
+#if defined(FORTH_INCLUDE_LOCALS)
+	ctx->fp = 0;
+#endif
+	ctx->state = 0;
+	ctx->throw_handler = 0;
+	ctx->bye_handler = 0;
+	ctx->quit_handler = 0;
+	ctx->suspend_handler = 0;
+	ctx->steps_left = 0;
+	ctx->nesting = 0;
+	ctx->user_break = 0;
+	ctx->blk = 0;
+	ctx->source_id = 0;
+	ctx->source_address = 0;
+	ctx->source_length = 0;
+	ctx->to_in = 0;
+	ctx->line_no = 0;
+	ctx->defining = 0;
+	ctx->trace = 0;
+	ctx->terminal_col = 0;
+
+	ctx->cold->session_line = 0;
+	ctx->cold->feed_address = 0;
+	ctx->cold->feed_length = 0;
+	ctx->cold->feed_pending = 0;
+	ctx->cold->abort_msg_len = 0;
+	ctx->cold->abort_msg_addr = 0;
+	ctx->cold->error_source = 0;
+	ctx->cold->error_source_length = 0;
+	ctx->cold->error_blk = 0;
+	ctx->cold->error_position = 0;
+	ctx->cold->error_line = 0;
+	ctx->cold->error_source_id = 0;
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+	ctx->cold->including = 0;
+	ctx->cold->including_mapped = 0;
+	ctx->cold->source_file_position = 0;
+#endif
+	ctx->cold->tib_count = 0;
+#if defined(FORTH_INCLUDE_OUTPUT_BUFFER)
+	ctx->cold->output_count = 0;
+	ctx->cold->output_failed = 0;
+#endif
+#if defined(FORTH_INCLUDE_OUTPUT_CAPTURE)
+	ctx->cold->capturing = 0;
+	ctx->cold->capture_spill = 0;
+	ctx->cold->capture_last = 0;
+	ctx->cold->capture_heap = 0;
+#endif
+	forth_less_hash(ctx);
+
+	return 0;
+}
+
+// Initialize DST as a copy of ORIGIN (a context that has already been set up, e.g. a template kept by the application),
+// using the stacks, the search order area and the cold block given in INIT_DATA (its dictionary is ignored, DST uses the one of ORIGIN).
+// Only the dictionary, the search order, BASE and the devices are copied, the buffers in the cold block are not touched.
+// The evaluate cache is not shared (see forth_INHERIT_DEVICES()), the application can give DST one of its own.
+forth_scell_t Forth_CloneContext(forth_runtime_context_t *dst, const forth_runtime_context_t *origin, const forth_context_init_data_t *init_data)
+{
+#if !defined(FORTH_WITHOUT_COMPILATION)
+	forth_cell_t i;
+#endif
+
+	if ((0 == dst) || (0 == origin) || (dst == origin) || (0 == init_data) || (0 == init_data->data_stack) || (0 == init_data->return_stack) ||
+	    (0 == init_data->cold) || (8 > init_data->data_stack_cell_count) || (8 > init_data->return_stack_cell_count))
+	{
+		return -1;
+	}
+
+	memset(dst, 0, sizeof(forth_runtime_context_t));	// Whatever is not copied from ORIGIN starts as in a new context.
+	dst->cold = init_data->cold;
+	dst->cold->input_buffers = 1;
+
+	dst->sp_max = init_data->data_stack + (init_data->data_stack_cell_count - 1);
+	dst->sp_min = init_data->data_stack;
+	dst->sp0    = dst->sp_max;
+
+	dst->rp_max = init_data->return_stack + (init_data->return_stack_cell_count - 1);
+	dst->rp_min = init_data->return_stack;
+	dst->rp0    = dst->rp_max;
+
+	dst->dictionary = origin->dictionary;
+#if defined(FORTH_INCLUDE_THREADS)
+	dst->dictionary_frozen = origin->dictionary_frozen;
+#endif
+	forth_INHERIT_DEVICES(dst, origin);
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+	dst->eval_cache = 0;
+#endif
+
+#if !defined(FORTH_WITHOUT_COMPILATION)
+	// The search order is kept at the end of the slots.
+	if ((0 == init_data->search_order) || (init_data->search_order_slots < 8) || (init_data->search_order_slots < origin->wordlist_cnt))
+	{
+		return -1;
+	}
+
+	dst->wordlists = init_data->search_order;
+	dst->wordlist_slots = init_data->search_order_slots;
+	dst->wordlist_cnt = origin->wordlist_cnt;
+
+	for (i = 1; i <= origin->wordlist_cnt; i++)
+	{
+		dst->wordlists[dst->wordlist_slots - i] = origin->wordlists[origin->wordlist_slots - i];
+	}
+
+	dst->current = origin->current;
+
+	if (0 != dst->dictionary)
+	{
+		FORTH_NAMES_CHANGED(dst);
+	}
+#endif
+
+	return Forth_ResetContext(dst);
+}
+
+// Make CTX use the same devices as PARENT (used for contexts created by the Forth system itself, such as tasks).
+void forth_INHERIT_DEVICES(forth_runtime_context_t *ctx, const forth_runtime_context_t *parent)
+{
+#if defined(FORTH_INCLUDE_BLOCKS)
+	ctx->block_buffers = parent->block_buffers;
+#endif
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION)
+	ctx->heap = parent->heap;
+#endif
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+	ctx->file_ops = parent->file_ops;
+#endif
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+	ctx->eval_cache = 0;	// The cache is not thread safe and a task could evict the strings its creator is interpreting.
+#endif
+	ctx->base = parent->base;
+	ctx->terminal_width = parent->terminal_width;
+	ctx->terminal_height = parent->terminal_height;
+	ctx->page = parent->page;
+	ctx->at_xy = parent->at_xy;
+	ctx->write_string = parent->write_string;
+	ctx->send_cr = parent->send_cr;
+	ctx->accept_string = parent->accept_string;
+	ctx->key = parent->key;
+	ctx->key_q = parent->key_q;
+	ctx->ekey = parent->ekey;
+	ctx->ekey_q = parent->ekey_q;
+	ctx->ekey_to_char = parent->ekey_to_char;
+	ctx->pause = parent->pause;
+}
+
 // Run the function which has the signature void f(forth_runtime_context_ctx *ctx) through Forth's CATCH.
 // Return the code from CATCH (i.e. zero on success and a small negative integer on failure).
 // It is useful to run C functions that call things int he Forth system that may throw an exeception.
@@ -5049,6 +6415,7 @@ forth_scell_t Forth_InitContext(forth_runtime_context_t *ctx, const forth_contex
 forth_scell_t Forth_Try(forth_runtime_context_t *ctx, forth_behavior_t f, char *name)
 {
 	forth_vocabulary_entry_t xt;
+	forth_scell_t res;
 
 	if ((0 == ctx) || (0 == f))
 	{
@@ -5074,32 +6441,14 @@ forth_scell_t Forth_Try(forth_runtime_context_t *ctx, forth_behavior_t f, char *
 	xt.meaning = (forth_cell_t)f;
 	xt.link = 0;
 
-	return forth_CATCH(ctx, &xt);
+	res = forth_CATCH(ctx, &xt);
+
+	return forth_FLUSH_ON_RETURN(ctx, res);
 }
 
-// Interpret the text in CMD.
-// The command is passed as address and length (so we can interpret substrings inside some bigger buffer).
-// A flag is passed to indicate if the data stack in the context needs to be emptied before running the command.
-//
-// This function returns 0 on success and a non-zero value (which is a code from CATCH/THROW) if an error has occurred.
-//
-forth_scell_t Forth(forth_runtime_context_t *ctx, const char *cmd, unsigned int cmd_length, int clear_stack)
+// Check if CTX has been set up properly so that it can be used to interpret commands.
+static forth_scell_t forth_CHECK_CONTEXT(forth_runtime_context_t *ctx)
 {
-    forth_cell_t res;
-    jmp_buf frame;
-
-    if (0 == cmd_length)
-    {
-        return 0;
-    }
-
-    if ((0 == ctx) || (0 == cmd))
-    {
-        return -9; // Invalid memory address, is there anything better here?
-    }
-
-	ctx->line_no = 0;
-
 	if ((0 == ctx->sp) || (0 == ctx->sp0) || (0 == ctx->sp_max) || (0 == ctx->sp_min) ||
 	    (0 == ctx->rp) || (0 == ctx->rp0) || (0 == ctx->rp_max) || (0 == ctx->rp_min))
 	{
@@ -5128,19 +6477,20 @@ forth_scell_t Forth(forth_runtime_context_t *ctx, const char *cmd, unsigned int
 	
 	ctx->user_break = 0;
 
-    ctx->bye_handler = 0;
-    ctx->quit_handler = 0;
-    ctx->throw_handler = 0;
-
-    if (0 != setjmp(frame))
-    {
-        return 0;
-    }
-
-    ctx->bye_handler = (forth_ucell_t)(&frame);
+	return 0;
+}
 
+// Reset the stacks and make CMD the input source.
+static void forth_SET_COMMAND(forth_runtime_context_t *ctx, const char *cmd, unsigned int cmd_length, int clear_stack)
+{
 	ctx->ip = 0;
     ctx->rp = ctx->rp0;
+#if defined(FORTH_INCLUDE_LOCALS)
+	ctx->fp = 0;
+#endif
+	ctx->nesting = 0;
+	ctx->steps_left = 0;
+	ctx->suspend_handler = 0;
 
     if (clear_stack)
     {
@@ -5152,8 +6502,321 @@ forth_scell_t Forth(forth_runtime_context_t *ctx, const char *cmd, unsigned int
     ctx->source_length = cmd_length;
 	ctx->source_id = -2;	// Multi-line evaluate.
 	ctx->blk = 0;
+}
+
+// Interpret the text in CMD.
+// The command is passed as address and length (so we can interpret substrings inside some bigger buffer).
+// A flag is passed to indicate if the data stack in the context needs to be emptied before running the command.
+//
+// This function returns 0 on success and a non-zero value (which is a code from CATCH/THROW) if an error has occurred.
+//
+forth_scell_t Forth(forth_runtime_context_t *ctx, const char *cmd, unsigned int cmd_length, int clear_stack)
+{
+    forth_cell_t res;
+    jmp_buf frame;
+
+    if (0 == cmd_length)
+    {
+        return 0;
+    }
+
+    if ((0 == ctx) || (0 == cmd))
+    {
+        return -9; // Invalid memory address, is there anything better here?
+    }
+
+	ctx->line_no = 0;
+
+	res = forth_CHECK_CONTEXT(ctx);
+
+	if (0 != res)
+	{
+		return res;
+	}
+
+    ctx->bye_handler = 0;
+    ctx->quit_handler = 0;
+    ctx->throw_handler = 0;
+
+    res = setjmp(frame);
+
+    if (0 != res)
+    {
+        return forth_FLUSH_ON_RETURN(ctx, (FORTH_EXIT_WOULD_BLOCK == res) ? FORTH_WOULD_BLOCK : 0);
+    }
+
+    ctx->bye_handler = (forth_ucell_t)(&frame);
+
+	forth_SET_COMMAND(ctx, cmd, cmd_length, clear_stack);
 
     res = forth_RUN_INTERPRET(ctx);
 
-    return (int)res;
+    return forth_FLUSH_ON_RETURN(ctx, res);
+}
+
+// Run the outer interpreter (after finishing the threaded code it was executing when it was suspended) until the input is
+// exhausted, an exception occurs, MAX_STEPS have been executed (FORTH_BUDGET_EXHAUSTED) or the input device would block
+// (FORTH_WOULD_BLOCK).
+// Steps are counted whenever the outer interpreter parses a word, a threaded definition is entered and a backward branch is taken.
+// Exceptions are handled right here instead of CATCH, so that there is no C code in between that would need to be unwound.
+// BYE and QUIT are left to the caller.
+forth_scell_t forth_RUN_RESUMABLE(forth_runtime_context_t *ctx, forth_cell_t max_steps)
+{
+	forth_scell_t res;
+	int exit_code;
+	jmp_buf suspend_frame;
+	jmp_buf throw_frame;
+
+	ctx->throw_handler = 0;
+	ctx->suspend_handler = 0;
+
+	exit_code = setjmp(suspend_frame);
+
+	if (0 != exit_code)
+	{
+		ctx->throw_handler = 0;
+		ctx->suspend_handler = 0;
+		ctx->steps_left = 0;
+
+		// See forth_OUT_OF_STEPS(), forth_WAIT_FOR_INPUT() and PAUSE.
+		return (FORTH_EXIT_WOULD_BLOCK == exit_code) ? FORTH_WOULD_BLOCK : FORTH_BUDGET_EXHAUSTED;
+	}
+
+	ctx->suspend_handler = (forth_ucell_t)(&suspend_frame);
+	ctx->steps_left = max_steps;
+	ctx->nesting = 0;
+
+	res = setjmp(throw_frame);
+
+	if (0 == res)
+	{
+		ctx->throw_handler = (forth_ucell_t)(&throw_frame);
+
+		if (0 != ctx->ip)
+		{
+			// Suspended inside threaded code, do what forth_InnerInterpreter() would have done.
+			ctx->nesting = 1;
+			forth_RUN_THREADED(ctx);
+			ctx->nesting = 0;
+		}
+
+		forth_interpret(ctx);
+	}
+	else
+	{
+		forth_INTERPRET_ERROR(ctx, res);
+		ctx->ip = 0;
+		ctx->sp = ctx->sp0;	// As QUIT does, the stack may not even be valid (e.g. after an underflow).
+		ctx->rp = ctx->rp0;
+#if defined(FORTH_INCLUDE_LOCALS)
+		ctx->fp = 0;
+#endif
+		ctx->cold->feed_pending = 0;
+		ctx->to_in = ctx->source_length; // Nothing to resume after an error.
+	}
+
+	ctx->throw_handler = 0;
+	ctx->suspend_handler = 0;
+	ctx->steps_left = 0;
+
+	return res;
+}
+
+// The common part of Forth_RunWithBudget() and Forth_Resume().
+static forth_scell_t forth_RUN_WITH_BUDGET(forth_runtime_context_t *ctx, forth_cell_t max_steps)
+{
+	forth_scell_t res;
+	jmp_buf bye_frame;
+
+	ctx->quit_handler = 0;
+
+	res = setjmp(bye_frame);
+
+	if (0 != res)
+	{
+		ctx->bye_handler = 0;
+		ctx->throw_handler = 0;
+		ctx->suspend_handler = 0;
+		ctx->steps_left = 0;
+
+		// BYE, or QUIT is waiting for input.
+		return forth_FLUSH_ON_RETURN(ctx, (FORTH_EXIT_WOULD_BLOCK == res) ? FORTH_WOULD_BLOCK : 0);
+	}
+
+	ctx->bye_handler = (forth_ucell_t)(&bye_frame);
+
+	res = forth_RUN_RESUMABLE(ctx, max_steps);
+
+	ctx->bye_handler = 0;
+
+	return forth_FLUSH_ON_RETURN(ctx, res);
+}
+
+// Interpret the text in CMD, but execute at most MAX_STEPS steps (0 means no limit).
+// If the budget runs out FORTH_BUDGET_EXHAUSTED is returned and the state of the interpreter is kept in CTX,
+// so that Forth_Resume() can continue later (CMD must stay valid until then).
+// Otherwise the return value is the same as that of Forth(). The data stack is not emptied.
+//
+// The interpreter can only be suspended while the outer interpreter or the threaded code it has started is running,
+// if the budget runs out while e.g. CATCH, EVALUATE or LOAD is executing FORTH_THROW_BUDGET_EXHAUSTED is thrown instead.
+forth_scell_t Forth_RunWithBudget(forth_runtime_context_t *ctx, const char *cmd, unsigned int cmd_length, forth_cell_t max_steps)
+{
+	forth_scell_t res;
+
+    if ((0 == ctx) || (0 == cmd))
+    {
+        return -9; // Invalid memory address, is there anything better here?
+    }
+
+	ctx->line_no = 0;
+
+	res = forth_CHECK_CONTEXT(ctx);
+
+	if (0 != res)
+	{
+		return res;
+	}
+
+	forth_SET_COMMAND(ctx, cmd, cmd_length, 0);
+
+	return forth_RUN_WITH_BUDGET(ctx, max_steps);
+}
+
+// Continue interpretation after Forth_RunWithBudget() (or an earlier Forth_Resume()) has returned FORTH_BUDGET_EXHAUSTED,
+// executing at most MORE_STEPS steps.
+forth_scell_t Forth_Resume(forth_runtime_context_t *ctx, forth_cell_t more_steps)
+{
+	forth_scell_t res;
+
+    if (0 == ctx)
+    {
+        return -9; // Invalid memory address, is there anything better here?
+    }
+
+	res = forth_CHECK_CONTEXT(ctx);
+
+	if (0 != res)
+	{
+		return res;
+	}
+
+	return forth_RUN_WITH_BUDGET(ctx, more_steps);
+}
+
+// Run an interactive session on the user input device (see QUIT), but return FORTH_WOULD_BLOCK to the caller instead of
+// waiting when no input is available. The session carries on where it has stopped the next time this is called.
+// Return 0 when the session is over (BYE or the end of the input) or -57 if the output has failed.
+static forth_scell_t forth_RUN_SESSION(forth_runtime_context_t *ctx)
+{
+	forth_scell_t res;
+	jmp_buf bye_frame;
+	jmp_buf quit_frame;
+
+	res = setjmp(bye_frame);
+
+	if (0 != res)
+	{
+		ctx->bye_handler = 0;
+		ctx->quit_handler = 0;
+		ctx->throw_handler = 0;
+		ctx->suspend_handler = 0;
+		ctx->cold->session_line = 0;
+
+		return (FORTH_EXIT_WOULD_BLOCK == res) ? FORTH_WOULD_BLOCK : 0;
+	}
+
+	if (0 != setjmp(quit_frame))
+	{
+		// QUIT has been executed, abandon the current line.
+		ctx->ip = 0;
+		ctx->rp = ctx->rp0;
+#if defined(FORTH_INCLUDE_LOCALS)
+		ctx->fp = 0;
+#endif
+		ctx->state = 0;
+		ctx->cold->feed_pending = 0;
+		ctx->cold->session_line = 0;
+	}
+
+	ctx->bye_handler = (forth_ucell_t)(&bye_frame);
+	ctx->quit_handler = (forth_ucell_t)(&quit_frame);
+	res = 0;
+
+	while (1)
+	{
+		if (0 != ctx->cold->session_line)
+		{
+			res = forth_RUN_RESUMABLE(ctx, 0);
+
+			if (FORTH_WOULD_BLOCK == res)
+			{
+				break;
+			}
+
+			ctx->cold->session_line = 0;
+
+			if (0 != res)
+			{
+				ctx->sp = ctx->sp0;
+			}
+			else if (0 == ctx->state)
+			{
+				// See QUIT.
+				if ((0 > forth_WRITE_STRING(ctx, "OK", 2)) || (0 > forth_SEND_CR(ctx)))
+				{
+					res = -57;
+					break;
+				}
+			}
+		}
+
+		ctx->source_id = 0;
+		res = forth_REFILL_TIB(ctx);
+
+		if (0 > res)
+		{
+			res = (FORTH_WOULD_BLOCK == res) ? FORTH_WOULD_BLOCK : 0;
+			break;
+		}
+
+		ctx->ip = 0;
+		ctx->cold->session_line = 1;
+	}
+
+	ctx->bye_handler = 0;
+	ctx->quit_handler = 0;
+
+	return res;
+}
+
+// Give BYTES to an interactive session (see QUIT) and run it until it needs more input (FORTH_WOULD_BLOCK is returned)
+// or it is over (0 is returned, after BYE or if there is no more input).
+// The input is used in place of the user input device (ACCEPT, KEY and REFILL), it is consumed by the time this function
+// returns. Incomplete lines and the state of the interpreter are kept in CTX, so the input can be given in arbitrary pieces.
+// If BYTES is 0 the session uses the input device as usual, whose functions may return FORTH_WOULD_BLOCK if there is no input.
+forth_scell_t Forth_Feed(forth_runtime_context_t *ctx, const char *bytes, unsigned int length)
+{
+	forth_scell_t res;
+
+    if (0 == ctx)
+    {
+        return -9; // Invalid memory address, is there anything better here?
+    }
+
+	res = forth_CHECK_CONTEXT(ctx);
+
+	if (0 != res)
+	{
+		return res;
+	}
+
+	ctx->cold->feed_address = bytes;
+	ctx->cold->feed_length = (0 == bytes) ? 0 : length;
+
+	res = forth_RUN_SESSION(ctx);
+
+	ctx->cold->feed_address = 0;
+	ctx->cold->feed_length = 0;
+
+	return forth_FLUSH_ON_RETURN(ctx, res);
 }
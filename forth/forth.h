@@ -39,9 +39,67 @@ extern "C" {
 // Some of the structs are defined in forth_internals.h because their structure is not part of the interface
 // and only the Forth implementation (but not code calling it) needs to know about the details.
 
+// Codes from the range reserved for the system (-4095 ... -256).
+#define FORTH_BUDGET_EXHAUSTED			(-256)	// Returned by Forth_RunWithBudget() and Forth_Resume(), call Forth_Resume() to continue.
+#define FORTH_THROW_BUDGET_EXHAUSTED	(-257)	// Thrown if the budget runs out where the interpreter cannot be suspended.
+#define FORTH_WOULD_BLOCK				(-258)	// No input is available yet, see Forth_Feed().
+#define FORTH_THROW_TOO_MANY_JOBS		(-259)	// SPAWN has run out of job slots.
+
 typedef struct forth_runtime_context forth_runtime_context_t;
+typedef struct forth_cold_context forth_cold_context_t;
 typedef void (*forth_behavior_t)(forth_runtime_context_t *ctx);
 typedef struct forth_dictionary forth_dictionary_t;
+typedef struct forth_heap forth_heap_t;
+typedef struct forth_eval_cache forth_eval_cache_t;
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+// File access methods (see R/O, W/O, R/W and BIN).
+#define FORTH_FAM_READ		1
+#define FORTH_FAM_WRITE		2
+#define FORTH_FAM_BIN		4
+
+// The file system used by the file access words, provided by the application (see forth_files.c).
+// A file is identified by a non-zero fileid chosen by the application. The functions return 0 on success or an ior
+// (a negative THROW code, e.g. -37 file I/O exception, -38 non-existent file) on failure.
+struct forth_file_ops
+{
+	forth_scell_t (*open)(forth_runtime_context_t *ctx, const char *name, forth_cell_t length, forth_cell_t fam, forth_cell_t *fileid);
+	forth_scell_t (*create)(forth_runtime_context_t *ctx, const char *name, forth_cell_t length, forth_cell_t fam, forth_cell_t *fileid);
+	forth_scell_t (*close)(forth_runtime_context_t *ctx, forth_cell_t fileid);
+	forth_scell_t (*read)(forth_runtime_context_t *ctx, forth_cell_t fileid, char *buffer, forth_cell_t length, forth_cell_t *count);
+	// Read at most LENGTH characters up to the end of the line (the line terminator is consumed but not stored).
+	// *FOUND is set to 0 if the end of the file has been reached before anything could be read.
+	forth_scell_t (*read_line)(forth_runtime_context_t *ctx, forth_cell_t fileid, char *buffer, forth_cell_t length, forth_cell_t *count, forth_cell_t *found);
+	forth_scell_t (*write)(forth_runtime_context_t *ctx, forth_cell_t fileid, const char *buffer, forth_cell_t length);
+	forth_scell_t (*position)(forth_runtime_context_t *ctx, forth_cell_t fileid, forth_dcell_t *position);
+	forth_scell_t (*reposition)(forth_runtime_context_t *ctx, forth_cell_t fileid, forth_dcell_t position);
+	forth_scell_t (*size)(forth_runtime_context_t *ctx, forth_cell_t fileid, forth_dcell_t *size);
+	forth_scell_t (*flush)(forth_runtime_context_t *ctx, forth_cell_t fileid);
+	forth_scell_t (*remove)(forth_runtime_context_t *ctx, const char *name, forth_cell_t length);
+	// Optional (0 if not supported): map the rest of the file (from its current position) into memory read-only,
+	// so INCLUDE-FILE can interpret it in place. A non-zero return value makes INCLUDE-FILE read the file a line at a time.
+	forth_scell_t (*map)(forth_runtime_context_t *ctx, forth_cell_t fileid, const char **address, forth_cell_t *length);
+	forth_scell_t (*unmap)(forth_runtime_context_t *ctx, forth_cell_t fileid, const char *address, forth_cell_t length);
+};
+typedef struct forth_file_ops forth_file_ops_t;
+#endif
+#if defined(FORTH_INCLUDE_OUTPUT_CAPTURE)
+// The output captured by Forth_RunCapture() that did not fit in the buffer of the caller.
+typedef struct forth_capture_chunk forth_capture_chunk_t;
+struct forth_capture_chunk
+{
+	forth_capture_chunk_t	*next;
+	forth_cell_t			length;			// The number of characters in DATA.
+	forth_cell_t			capacity;
+	char					data[1];
+};
+#endif
+#if defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+// Called when the dictionary is full, it should return the address of a new (cell aligned) segment of at least
+// MIN_LENGTH bytes and store its actual length in *LENGTH, or return 0 if no more memory can be given to the dictionary.
+// With FORTH_TOKEN_THREADED the whole segment must be within +/- 8 GiB of the dictionary (the reach of a token), which
+// memory from malloc() is not guaranteed to be, a segment out of reach is refused (the dictionary is full, -8).
+typedef void *(*forth_segment_provider_t)(forth_dictionary_t *dictionary, forth_cell_t min_length, forth_cell_t *length);
+#endif
 
 struct forth_context_init_data
 {
@@ -52,14 +110,51 @@ struct forth_context_init_data
     forth_cell_t return_stack_cell_count;   // The size of the data stack in cells.
     forth_cell_t *search_order;             // The address of the cells to be used for search order.
     forth_cell_t search_order_slots;        // The number of cells in the search order area.
+    forth_cold_context_t *cold;             // Memory for the rarely used part of the context (Forth_GetColdContextSize() bytes).
 };
 typedef struct forth_context_init_data forth_context_init_data_t;
 
 extern forth_cell_t Forth_GetContextSize(void);
+extern forth_cell_t Forth_GetColdContextSize(void);
 extern forth_scell_t Forth_InitContext(forth_runtime_context_t *ctx, const forth_context_init_data_t *init_data);
+extern forth_scell_t Forth_CloneContext(forth_runtime_context_t *dst, const forth_runtime_context_t *origin, const forth_context_init_data_t *init_data);
+extern forth_scell_t Forth_ResetContext(forth_runtime_context_t *ctx);
 extern forth_dictionary_t *Forth_InitDictionary(void *addr, forth_cell_t length);
+#if defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+extern void Forth_SetSegmentProvider(forth_dictionary_t *dictionary, forth_segment_provider_t provider);
+#endif
+#if defined(FORTH_SEPARATE_HEADS)
+extern forth_cell_t Forth_GetHeadSpace(forth_dictionary_t *dictionary, void **start);
+#endif
 extern forth_scell_t Forth_Try(forth_runtime_context_t *ctx, forth_behavior_t f, char *name);
 extern forth_scell_t Forth(forth_runtime_context_t *ctx, const char *cmd, unsigned int cmd_length, int clear_stack);
+extern forth_scell_t Forth_RunWithBudget(forth_runtime_context_t *ctx, const char *cmd, unsigned int cmd_length, forth_cell_t max_steps);
+extern forth_scell_t Forth_Resume(forth_runtime_context_t *ctx, forth_cell_t more_steps);
+extern forth_scell_t Forth_Feed(forth_runtime_context_t *ctx, const char *bytes, unsigned int length);
+#if defined(FORTH_INCLUDE_TASKS)
+extern forth_scell_t Forth_RunTasks(forth_runtime_context_t *ctx, forth_cell_t max_steps);
+#endif
+#if defined(FORTH_INCLUDE_THREADS)
+extern forth_cell_t Forth_GetWorkerPoolSize(unsigned int worker_count);
+extern forth_scell_t Forth_StartWorkers(forth_runtime_context_t *ctx, void *memory, unsigned int worker_count);
+extern void Forth_StopWorkers(forth_runtime_context_t *ctx);
+#endif
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION)
+extern forth_heap_t *Forth_InitHeap(void *addr, forth_cell_t length);
+#endif
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+extern forth_eval_cache_t *Forth_InitEvaluateCache(void *addr, forth_cell_t length);
+#endif
+#if defined(FORTH_INCLUDE_OUTPUT_CAPTURE)
+extern forth_scell_t Forth_RunCapture(forth_runtime_context_t *ctx, const char *cmd, unsigned int cmd_length, char *out, forth_cell_t capacity, forth_cell_t *written);
+extern const forth_capture_chunk_t *Forth_GetCaptureSpill(forth_runtime_context_t *ctx);
+extern void Forth_ReleaseCaptureSpill(forth_runtime_context_t *ctx);
+#endif
+#if defined(FORTH_INCLUDE_CHANNELS)
+extern void *Forth_GetChannel(forth_runtime_context_t *ctx, const char *name);
+extern forth_scell_t Forth_ChannelSend(void *channel, forth_cell_t x);
+extern forth_scell_t Forth_ChannelReceive(void *channel, forth_cell_t *x);
+#endif
 
 #ifdef __cplusplus
 }
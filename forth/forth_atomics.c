@@ -0,0 +1,99 @@
+/*
+* forth_atomics.c
+*
+*  Created on: Oct 18, 2026
+*      Author: Andras Zsoter
+*
+* Copyright (c) 2026 Andras Zsoter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+#include <forth.h>
+#include <forth_internal.h>
+
+#if defined(FORTH_INCLUDE_ATOMICS)
+#include <stdatomic.h>
+
+// Atomic access to cells shared with other contexts (worker threads) or with the application's threads.
+// All of these are sequentially consistent, the address must be aligned.
+
+// Return ADDR as a pointer to an atomic cell, throw if it is not aligned.
+static _Atomic forth_cell_t *forth_ATOMIC_CELL(forth_runtime_context_t *ctx, forth_cell_t addr)
+{
+	if (0 != (addr & ~FORTH_ALIGNED_MASK))
+	{
+		forth_THROW(ctx, -23); // Address alignment exception.
+	}
+
+	return (_Atomic forth_cell_t *)addr;
+}
+
+// ATOMIC@ ( addr -- x )
+void forth_atomic_fetch(forth_runtime_context_t *ctx)
+{
+	_Atomic forth_cell_t *p = forth_ATOMIC_CELL(ctx, forth_POP(ctx));
+	forth_PUSH(ctx, atomic_load(p));
+}
+
+// ATOMIC! ( x addr -- )
+void forth_atomic_store(forth_runtime_context_t *ctx)
+{
+	_Atomic forth_cell_t *p = forth_ATOMIC_CELL(ctx, forth_POP(ctx));
+	forth_cell_t x = forth_POP(ctx);
+	atomic_store(p, x);
+}
+
+// ATOMIC+! ( n addr -- )
+void forth_atomic_plus_store(forth_runtime_context_t *ctx)
+{
+	_Atomic forth_cell_t *p = forth_ATOMIC_CELL(ctx, forth_POP(ctx));
+	forth_cell_t n = forth_POP(ctx);
+	(void)atomic_fetch_add(p, n);
+}
+
+// CAS ( new old addr -- flag )
+// If the cell at ADDR contains OLD replace it with NEW, FLAG is true if the cell has been replaced.
+void forth_cas(forth_runtime_context_t *ctx)
+{
+	_Atomic forth_cell_t *p = forth_ATOMIC_CELL(ctx, forth_POP(ctx));
+	forth_cell_t old = forth_POP(ctx);
+	forth_cell_t new_value = forth_POP(ctx);
+
+	forth_PUSH(ctx, atomic_compare_exchange_strong(p, &old, new_value) ? FORTH_TRUE : FORTH_FALSE);
+}
+
+// FENCE ( -- )
+// Full memory barrier, so plain @ and ! are ordered with respect to other threads.
+void forth_fence(forth_runtime_context_t *ctx)
+{
+	atomic_thread_fence(memory_order_seq_cst);
+}
+
+const forth_vocabulary_entry_t forth_wl_atomics[] =
+{
+DEF_FORTH_WORD( "atomic@",  	 0, forth_atomic_fetch,      	"( addr -- x )"),
+DEF_FORTH_WORD( "atomic!",  	 0, forth_atomic_store,      	"( x addr -- )"),
+DEF_FORTH_WORD( "atomic+!",  	 0, forth_atomic_plus_store,   	"( n addr -- )"),
+DEF_FORTH_WORD( "cas",  		 0, forth_cas,      			"( new old addr -- flag )"),
+DEF_FORTH_WORD( "fence",  		 0, forth_fence,      			"( -- )"),
+DEF_FORTH_WORD(0, 0, 0, 0)
+};
+#endif
@@ -281,7 +281,7 @@ void forth_load(forth_runtime_context_t *ctx)
         forth_ADJUST_BLK_INPUT_SOURCE(ctx, saved_blk);
     }
 
-	forth_THROW(ctx, res);
+	forth_RETHROW(ctx, res);
 }
 
 // THRU ( first_blk last_blk -- )
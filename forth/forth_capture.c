@@ -0,0 +1,245 @@
+/*
+* forth_capture.c
+*
+*  Created on: Oct 18, 2026
+*      Author: Andras Zsoter
+*
+* Copyright (c) 2026 Andras Zsoter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+#include <forth.h>
+#include <forth_internal.h>
+#include <string.h>
+
+#if defined(FORTH_INCLUDE_OUTPUT_CAPTURE)
+// Capturing the output of a script for an embedding application (see Forth_RunCapture()).
+// While the script runs the output device of the context is replaced by a sink that writes straight into the buffer of
+// the caller, so the output can be handed over without copying it out of a buffer of the application's output device.
+// What does not fit spills into a chain of chunks allocated from the heap of the context (see Forth_InitHeap()), the
+// caller can walk the chain with Forth_GetCaptureSpill() and must give it back with Forth_ReleaseCaptureSpill().
+// Only the output of the context itself is captured, tasks and worker threads keep their own output devices.
+
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION)
+// Return a new chunk (with room for at least LENGTH characters) at the end of the spill chain, 0 if there is no memory.
+static forth_capture_chunk_t *forth_CAPTURE_CHUNK(forth_runtime_context_t *ctx, forth_cell_t length)
+{
+	forth_cold_context_t *cold = ctx->cold;
+	forth_cell_t capacity = (length > FORTH_CAPTURE_CHUNK_SIZE) ? length : FORTH_CAPTURE_CHUNK_SIZE;
+	forth_capture_chunk_t *chunk;
+
+	if (0 == ctx->heap)
+	{
+		return 0;
+	}
+
+	chunk = (forth_capture_chunk_t *)forth_HEAP_ALLOCATE(ctx->heap, sizeof(forth_capture_chunk_t) + capacity);
+
+	if (0 != chunk)
+	{
+		chunk->next = 0;
+		chunk->length = 0;
+		chunk->capacity = capacity;
+
+		if (0 == cold->capture_last)
+		{
+			cold->capture_spill = chunk;
+			cold->capture_heap = ctx->heap;
+		}
+		else
+		{
+			cold->capture_last->next = chunk;
+		}
+
+		cold->capture_last = chunk;
+	}
+
+	return chunk;
+}
+#else
+#define forth_CAPTURE_CHUNK(CTX, LENGTH) ((forth_capture_chunk_t *)0)
+#endif
+
+// The write_string() of the sink.
+static int forth_CAPTURE_WRITE(forth_runtime_context_t *ctx, const char *str, forth_cell_t length)
+{
+	forth_cold_context_t *cold = ctx->cold;
+	forth_capture_chunk_t *chunk;
+	forth_cell_t n;
+
+	if (0 == cold->capturing)
+	{
+		return 0; // A task created while capturing has inherited the sink, but it has nowhere to write to.
+	}
+
+	ctx->terminal_col += length;
+	cold->capture_length += length;
+
+	if (cold->capture_used < cold->capture_capacity)
+	{
+		n = cold->capture_capacity - cold->capture_used;
+		n = (length < n) ? length : n;
+		memcpy(cold->capture_address + cold->capture_used, str, n);
+		cold->capture_used += n;
+		str += n;
+		length -= n;
+	}
+
+	while (0 != length)
+	{
+		chunk = cold->capture_last;
+
+		if ((0 == chunk) || (chunk->length == chunk->capacity))
+		{
+			chunk = forth_CAPTURE_CHUNK(ctx, length);
+
+			if (0 == chunk)
+			{
+				cold->capture_length -= length; // Lost.
+				return -1;
+			}
+		}
+
+		n = chunk->capacity - chunk->length;
+		n = (length < n) ? length : n;
+		memcpy(chunk->data + chunk->length, str, n);
+		chunk->length += n;
+		str += n;
+		length -= n;
+	}
+
+	return 0;
+}
+
+// The send_cr() of the sink.
+static int forth_CAPTURE_CR(forth_runtime_context_t *ctx)
+{
+	int res = forth_CAPTURE_WRITE(ctx, "\n", 1);
+
+	ctx->terminal_col = 0;
+	return res;
+}
+
+// Interpret CMD (like Forth(), the data stack is not emptied) with its output written into the CAPACITY bytes at OUT.
+// The number of characters written is stored in *WRITTEN, if it is more than CAPACITY the rest is in the chain of chunks
+// returned by Forth_GetCaptureSpill() (which stays valid until Forth_ReleaseCaptureSpill() or the next capture).
+// PAGE and AT-XY are not supported while capturing.
+// The return value is the same as that of Forth(), if the output could not be spilled (there is no heap or it is full)
+// the script is aborted with -57 (exception in sending or receiving a character), or -57 is returned if the output that
+// did not fit has only been found out when it was flushed at the end.
+forth_scell_t Forth_RunCapture(forth_runtime_context_t *ctx, const char *cmd, unsigned int cmd_length, char *out, forth_cell_t capacity, forth_cell_t *written)
+{
+	forth_cold_context_t *cold;
+	int (*saved_write_string)(struct forth_runtime_context *rctx, const char *str, forth_cell_t length);
+	int (*saved_send_cr)(struct forth_runtime_context *rctx);
+	int (*saved_page)(struct forth_runtime_context *rctx);
+	int (*saved_at_xy)(struct forth_runtime_context *rctx, forth_cell_t x, forth_cell_t y);
+	forth_cell_t saved_terminal_col;
+	forth_scell_t res;
+
+	if ((0 == ctx) || (0 == ctx->cold) || ((0 == out) && (0 != capacity)))
+	{
+		return -9; // Invalid memory address, is there anything better here?
+	}
+
+	cold = ctx->cold;
+
+	if (0 != cold->capturing)
+	{
+		return -21; // Unsupported operation -- already capturing.
+	}
+
+	if ((0 != ctx->write_string) && (0 != forth_FLUSH_ON_RETURN(ctx, 0)))
+	{
+		return -57; // The output so far belongs to the output device.
+	}
+
+	Forth_ReleaseCaptureSpill(ctx);
+	saved_write_string = ctx->write_string;
+	saved_send_cr = ctx->send_cr;
+	saved_page = ctx->page;
+	saved_at_xy = ctx->at_xy;
+	saved_terminal_col = ctx->terminal_col;
+
+	cold->capturing = 1;
+	cold->capture_address = out;
+	cold->capture_capacity = capacity;
+	cold->capture_used = 0;
+	cold->capture_length = 0;
+	ctx->write_string = &forth_CAPTURE_WRITE;
+	ctx->send_cr = &forth_CAPTURE_CR;
+	ctx->page = 0;
+	ctx->at_xy = 0;
+	ctx->terminal_col = 0;
+
+	res = Forth(ctx, cmd, cmd_length, 0);
+
+	ctx->write_string = saved_write_string;
+	ctx->send_cr = saved_send_cr;
+	ctx->page = saved_page;
+	ctx->at_xy = saved_at_xy;
+	ctx->terminal_col = saved_terminal_col;
+	cold->capturing = 0;
+	cold->capture_address = 0;
+
+	if (0 != written)
+	{
+		*written = cold->capture_length;
+	}
+
+	return res;
+}
+
+// The output of the last Forth_RunCapture() that did not fit in its buffer (0 if there was none).
+const forth_capture_chunk_t *Forth_GetCaptureSpill(forth_runtime_context_t *ctx)
+{
+	return ((0 == ctx) || (0 == ctx->cold)) ? 0 : ctx->cold->capture_spill;
+}
+
+// Give the chunks of the spill chain back to the heap.
+// The chunks belong to the heap the context had when they were allocated, if the application has removed or replaced
+// that heap since, the chain is only forgotten (the memory of the old heap is the application's to reuse).
+void Forth_ReleaseCaptureSpill(forth_runtime_context_t *ctx)
+{
+	forth_capture_chunk_t *chunk;
+	forth_capture_chunk_t *next;
+
+	if ((0 == ctx) || (0 == ctx->cold))
+	{
+		return;
+	}
+
+	for (chunk = ctx->cold->capture_spill; 0 != chunk; chunk = next)
+	{
+		next = chunk->next;
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION)
+		if ((0 != ctx->heap) && (ctx->heap == ctx->cold->capture_heap))
+		{
+			(void)forth_HEAP_FREE(ctx->heap, (forth_cell_t)chunk);
+		}
+#endif
+	}
+
+	ctx->cold->capture_spill = 0;
+	ctx->cold->capture_last = 0;
+	ctx->cold->capture_heap = 0;
+}
+#endif
@@ -0,0 +1,333 @@
+/*
+* forth_channels.c
+*
+*  Created on: Oct 18, 2026
+*      Author: Andras Zsoter
+*
+* Copyright (c) 2026 Andras Zsoter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+#include <forth.h>
+#include <forth_internal.h>
+#include <string.h>
+
+#if !defined(FORTH_WITHOUT_COMPILATION) && defined(FORTH_INCLUDE_CHANNELS)
+#include <stdatomic.h>
+
+// Channels are bounded lock-free ring buffers in the dictionary for passing cells between contexts (tasks, worker threads)
+// and the application.
+// Each slot has a sequence number telling whose turn it is: a producer can fill slot N when its sequence is N,
+// the consumer can empty it when its sequence is N + 1 (this is D. Vyukov's bounded queue).
+// A channel created by CHANNEL has a single producer and a single consumer, one created by MP-CHANNEL can have
+// several producers (which claim slots with a compare and swap), both have a single consumer.
+
+struct forth_channel_slot
+{
+	_Atomic forth_cell_t	sequence;
+	forth_cell_t			value;
+};
+typedef struct forth_channel_slot forth_channel_slot_t;
+
+#define FORTH_CHANNEL_MAGIC ((forth_cell_t)0x4348414EUL)	// "CHAN", tells a channel from any other address.
+
+struct forth_channel
+{
+	forth_cell_t				magic;				// FORTH_CHANNEL_MAGIC.
+	forth_cell_t				mask;				// The number of slots - 1, the number of slots is a power of 2.
+	forth_cell_t				multi_producer;
+	_Atomic forth_cell_t		head;				// The next slot to be received from.
+	_Atomic forth_cell_t		tail;				// The next slot to be sent to.
+	forth_channel_slot_t		slots[1];			// Place holder for MASK + 1 slots.
+};
+typedef struct forth_channel forth_channel_t;
+
+// Return CHANNEL if it has been created by CHANNEL or MP-CHANNEL, 0 otherwise.
+static forth_channel_t *forth_CHANNEL(forth_cell_t channel)
+{
+	return ((0 != channel) && (0 == (channel & ~FORTH_ALIGNED_MASK)) && (FORTH_CHANNEL_MAGIC == ((forth_channel_t *)channel)->magic))
+		? (forth_channel_t *)channel : 0;
+}
+
+// Return the channel on the top of the stack of CTX, throw if it is not a channel.
+static forth_channel_t *forth_CHECK_CHANNEL(forth_runtime_context_t *ctx)
+{
+	forth_CHECK_STACK_AT_LEAST(ctx, 1);
+
+	if (0 == forth_CHANNEL(ctx->sp[0]))
+	{
+		forth_THROW(ctx, -9); // Invalid memory address -- not a channel.
+	}
+
+	return (forth_channel_t *)(ctx->sp[0]);
+}
+
+// Try to put X into CHANNEL, return 0 if it is full.
+static int forth_CHANNEL_SEND(forth_channel_t *channel, forth_cell_t x)
+{
+	forth_channel_slot_t *slot;
+	forth_cell_t pos = atomic_load_explicit(&(channel->tail), memory_order_relaxed);
+	forth_scell_t diff;
+
+	while (1)
+	{
+		slot = &(channel->slots[pos & channel->mask]);
+		diff = (forth_scell_t)(atomic_load_explicit(&(slot->sequence), memory_order_acquire) - pos);
+
+		if (0 > diff)
+		{
+			return 0; // Full, the consumer has not emptied the slot yet.
+		}
+
+		if (0 == diff)
+		{
+			if (0 == channel->multi_producer)
+			{
+				atomic_store_explicit(&(channel->tail), pos + 1, memory_order_relaxed);
+				break;
+			}
+
+			if (atomic_compare_exchange_weak_explicit(&(channel->tail), &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else
+		{
+			// Another producer has taken the slot.
+			pos = atomic_load_explicit(&(channel->tail), memory_order_relaxed);
+		}
+	}
+
+	slot->value = x;
+	atomic_store_explicit(&(slot->sequence), pos + 1, memory_order_release);
+
+	return 1;
+}
+
+// Try to take a cell from CHANNEL into *X, return 0 if it is empty.
+static int forth_CHANNEL_RECEIVE(forth_channel_t *channel, forth_cell_t *x)
+{
+	forth_cell_t pos = atomic_load_explicit(&(channel->head), memory_order_relaxed);
+	forth_channel_slot_t *slot = &(channel->slots[pos & channel->mask]);
+
+	if ((pos + 1) != atomic_load_explicit(&(slot->sequence), memory_order_acquire))
+	{
+		return 0; // Empty (or the producer has not finished writing the slot yet).
+	}
+
+	*x = slot->value;
+	atomic_store_explicit(&(channel->head), pos + 1, memory_order_relaxed);
+	atomic_store_explicit(&(slot->sequence), pos + channel->mask + 1, memory_order_release);
+
+	return 1;
+}
+
+// The blocking primitive F cannot proceed, let others run.
+// If CTX can be suspended (a task, Forth_Feed(), Forth_RunWithBudget()) F is executed again when it is resumed,
+// otherwise this returns and F tries again.
+static void forth_CHANNEL_WAIT(forth_runtime_context_t *ctx, forth_behavior_t f)
+{
+	forth_WAIT_FOR_INPUT(ctx, f);
+
+#if defined(FORTH_INCLUDE_TASKS)
+	forth_pause(ctx);
+#else
+	if (0 != ctx->pause)
+	{
+		(void)ctx->pause(ctx);
+	}
+#endif
+}
+
+// Create a channel with at least N slots.
+static void forth_CREATE_CHANNEL(forth_runtime_context_t *ctx, forth_cell_t multi_producer)
+{
+	forth_vocabulary_entry_t *entry;
+	forth_channel_t *channel;
+	forth_cell_t n = forth_POP(ctx);
+	forth_cell_t slots = 1;
+	forth_cell_t i;
+
+	if (0 == n)
+	{
+		forth_THROW(ctx, -24); // Invalid numeric argument.
+	}
+
+	if (n > (ctx->dictionary->dp_max / sizeof(forth_channel_slot_t)))
+	{
+		forth_THROW(ctx, -8); // Dictionary overflow.
+	}
+
+	while (slots < n)
+	{
+		slots <<= 1;
+	}
+
+	entry = forth_PARSE_NAME_AND_CREATE_ENTRY(ctx);
+	FORTH_SET_XT_FLAGS(entry, FORTH_XT_FLAGS_ACTION_CONSTANT);
+	forth_here(ctx);
+	channel = (forth_channel_t *)(forth_POP(ctx) + sizeof(forth_cell_t));
+	forth_COMMA(ctx, (forth_cell_t)channel); // Meaning.
+	forth_PUSH(ctx, sizeof(forth_channel_t) + ((slots - 1) * sizeof(forth_channel_slot_t)));
+	forth_allot(ctx);
+
+	channel->magic = FORTH_CHANNEL_MAGIC;
+	channel->mask = slots - 1;
+	channel->multi_producer = multi_producer;
+	atomic_init(&(channel->head), 0);
+	atomic_init(&(channel->tail), 0);
+
+	for (i = 0; i < slots; i++)
+	{
+		atomic_init(&(channel->slots[i].sequence), i);
+		channel->slots[i].value = 0;
+	}
+
+	forth_SET_LINK(ctx, entry, forth_GET_LATEST(ctx));
+	forth_SET_LATEST(ctx, entry);
+}
+
+// CHANNEL ( n "<name>" -- )
+// Create a channel for a single producer and a single consumer with room for at least N cells, name ( -- ch ).
+void forth_channel(forth_runtime_context_t *ctx)
+{
+	forth_CREATE_CHANNEL(ctx, 0);
+}
+
+// MP-CHANNEL ( n "<name>" -- )
+// Create a channel for several producers and a single consumer with room for at least N cells, name ( -- ch ).
+void forth_mp_channel(forth_runtime_context_t *ctx)
+{
+	forth_CREATE_CHANNEL(ctx, 1);
+}
+
+// SEND ( x ch -- )
+// Put X into the channel, wait while it is full.
+void forth_send(forth_runtime_context_t *ctx)
+{
+	forth_channel_t *channel = forth_CHECK_CHANNEL(ctx);
+
+	forth_CHECK_STACK_AT_LEAST(ctx, 2);
+
+	while (!forth_CHANNEL_SEND(channel, ctx->sp[1]))
+	{
+		forth_CHANNEL_WAIT(ctx, forth_send);
+	}
+
+	ctx->sp += 2;
+}
+
+// RECV ( ch -- x )
+// Take the next cell from the channel, wait while it is empty.
+void forth_recv(forth_runtime_context_t *ctx)
+{
+	forth_channel_t *channel = forth_CHECK_CHANNEL(ctx);
+	forth_cell_t x;
+
+	while (!forth_CHANNEL_RECEIVE(channel, &x))
+	{
+		forth_CHANNEL_WAIT(ctx, forth_recv);
+	}
+
+	ctx->sp[0] = x;
+}
+
+// TRY-RECV ( ch -- x true | 0 false )
+void forth_try_recv(forth_runtime_context_t *ctx)
+{
+	forth_channel_t *channel = forth_CHECK_CHANNEL(ctx);
+	forth_cell_t x = 0;
+
+	ctx->sp++;
+
+	if (forth_CHANNEL_RECEIVE(channel, &x))
+	{
+		forth_PUSH(ctx, x);
+		forth_PUSH(ctx, FORTH_TRUE);
+	}
+	else
+	{
+		forth_PUSH(ctx, 0);
+		forth_PUSH(ctx, FORTH_FALSE);
+	}
+}
+
+// Return the channel called NAME in the search order of CTX, 0 if there is no such word or it is not a channel.
+void *Forth_GetChannel(forth_runtime_context_t *ctx, const char *name)
+{
+	forth_xt_t xt;
+	forth_scell_t res;
+
+	if ((0 == ctx) || (0 == name) || ((ctx->sp - 2) < ctx->sp_min))
+	{
+		return 0;
+	}
+
+	forth_PUSH(ctx, (forth_cell_t)name);
+	forth_PUSH(ctx, strlen(name));
+	res = Forth_Try(ctx, forth_find_name, 0);
+	xt = (forth_xt_t)forth_POP(ctx);
+
+	// The body of a channel follows its header (see forth_CREATE_CHANNEL()), the value of any other constant is not
+	// even looked at.
+	if ((0 != res) || (0 == xt) || (FORTH_XT_FLAGS_ACTION_CONSTANT != (xt->flags & FORTH_XT_FLAGS_ACTION_MASK)) ||
+		((forth_cell_t)(&(xt->meaning) + 1) != xt->meaning))
+	{
+		return 0;
+	}
+
+	return (void *)forth_CHANNEL(xt->meaning);
+}
+
+// Put X into CHANNEL without waiting, return 0 on success or FORTH_WOULD_BLOCK if the channel is full.
+// The application counts as a producer: only channels created by MP-CHANNEL can have other producers as well.
+forth_scell_t Forth_ChannelSend(void *channel, forth_cell_t x)
+{
+	if (0 == forth_CHANNEL((forth_cell_t)channel))
+	{
+		return -9; // Invalid memory address.
+	}
+
+	return forth_CHANNEL_SEND((forth_channel_t *)channel, x) ? 0 : FORTH_WOULD_BLOCK;
+}
+
+// Take a cell from CHANNEL into *X without waiting, return 0 on success or FORTH_WOULD_BLOCK if the channel is empty.
+forth_scell_t Forth_ChannelReceive(void *channel, forth_cell_t *x)
+{
+	if ((0 == forth_CHANNEL((forth_cell_t)channel)) || (0 == x))
+	{
+		return -9; // Invalid memory address.
+	}
+
+	return forth_CHANNEL_RECEIVE((forth_channel_t *)channel, x) ? 0 : FORTH_WOULD_BLOCK;
+}
+
+const forth_vocabulary_entry_t forth_wl_channels[] =
+{
+DEF_FORTH_WORD( "channel",  	 0, forth_channel,      	"( n \"<name>\" -- )"),
+DEF_FORTH_WORD( "mp-channel",  	 0, forth_mp_channel,      	"( n \"<name>\" -- )"),
+DEF_FORTH_WORD( "send",  		 0, forth_send,      		"( x ch -- )"),
+DEF_FORTH_WORD( "recv",  		 0, forth_recv,      		"( ch -- x )"),
+DEF_FORTH_WORD( "try-recv",  	 0, forth_try_recv,      	"( ch -- x true | 0 false )"),
+DEF_FORTH_WORD(0, 0, 0, 0)
+};
+#endif
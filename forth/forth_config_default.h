@@ -80,6 +80,84 @@ typedef forth_ucell_t forth_cell_t;
 
 #define FORTH_NUM_BUFF_LENGTH (128 + 4)
 
+// FORTH_GUARDED_STACKS: PUSH, POP, etc. do not check the stack bounds, the application must put the stacks between
+// guard pages and turn the faults into exceptions (see forth_GUARDED_STACK_FAULT()).
+// Tasks and worker threads have their stacks in ordinary memory, so they need the checks.
+#if defined(FORTH_GUARDED_STACKS) && (defined(FORTH_INCLUDE_TASKS) || defined(FORTH_INCLUDE_THREADS))
+#error FORTH_GUARDED_STACKS cannot be used together with FORTH_INCLUDE_TASKS or FORTH_INCLUDE_THREADS.
+#endif
+
+// FORTH_TOKEN_THREADED: threaded code is made of 32 bit tokens instead of 64 bit cells, see forth_TOKEN_TO_XT().
+#if defined(FORTH_TOKEN_THREADED) && !defined(FORTH_IS_64BIT)
+#error FORTH_TOKEN_THREADED is only useful (and supported) on 64 bit systems.
+#endif
+
+// FORTH_COMPACT_HEADERS: the words defined at runtime have a single cell header (see FORTH_XT_FLAGS_COMPACT).
+// The links are relative, so the dictionary must be contiguous.
+#if defined(FORTH_COMPACT_HEADERS) && defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+#error FORTH_COMPACT_HEADERS cannot be used together with FORTH_INCLUDE_DICTIONARY_SEGMENTS.
+#endif
+
+// FORTH_SEPARATE_HEADS: the names and links of the words defined at runtime are kept in a head space growing downwards
+// from the end of the dictionary, only a single cell of their headers is left between the code and data.
+#if defined(FORTH_SEPARATE_HEADS) && defined(FORTH_COMPACT_HEADERS)
+#error FORTH_SEPARATE_HEADS cannot be used together with FORTH_COMPACT_HEADERS.
+#endif
+#if defined(FORTH_SEPARATE_HEADS) && defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+#error FORTH_SEPARATE_HEADS cannot be used together with FORTH_INCLUDE_DICTIONARY_SEGMENTS.
+#endif
+
+#if defined(FORTH_COMPACT_HEADERS) || defined(FORTH_SEPARATE_HEADS)
+#define FORTH_ONE_CELL_HEADERS
+#endif
+
+#if defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+// The last cells of each segment are kept free for the branch to the next segment.
+#define FORTH_SEGMENT_RESERVE (2 * sizeof(forth_cell_t))
+// Compiling an xt makes sure that this much room is left for it and its inline operands.
+#define FORTH_SEGMENT_COMPILE_ROOM (6 * sizeof(forth_cell_t))
+// A new definition is started in a new segment unless there is this much room after its header.
+#if !defined(FORTH_SEGMENT_DEFINITION_ROOM)
+#define FORTH_SEGMENT_DEFINITION_ROOM (16 * sizeof(forth_cell_t))
+#endif
+#endif
+
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION)
+#define FORTH_HEAP_SIZE_CLASSES 6				// Small blocks of 2, 4, ... 64 cells come from slabs.
+#define FORTH_HEAP_SMALLEST_CLASS_CELLS 2
+#if !defined(FORTH_HEAP_SLAB_SIZE)
+#define FORTH_HEAP_SLAB_SIZE 1024				// Bytes carved from the region at a time for a size class.
+#endif
+#endif
+
+#if defined(FORTH_INCLUDE_OUTPUT_BUFFER)
+#if !defined(FORTH_OUTPUT_BUFFER_LENGTH)
+#define FORTH_OUTPUT_BUFFER_LENGTH 256			// Longer strings are given to the output device directly.
+#endif
+#endif
+
+#if defined(FORTH_INCLUDE_OUTPUT_CAPTURE)
+#if !defined(FORTH_CAPTURE_CHUNK_SIZE)
+#define FORTH_CAPTURE_CHUNK_SIZE 1024			// The smallest chunk the output spills into (see Forth_RunCapture()).
+#endif
+#endif
+
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+#if !defined(FORTH_FILE_INPUT_BUFFER_LENGTH)
+#define FORTH_FILE_INPUT_BUFFER_LENGTH 256		// The longest line INCLUDE-FILE reads at a time.
+#endif
+#define FORTH_ERROR_NAME_LENGTH 32				// See INCLUDE-FILE.
+#endif
+
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+#if defined(FORTH_WITHOUT_COMPILATION)
+#error FORTH_INCLUDE_EVALUATE_CACHE needs the dictionary, it cannot be used together with FORTH_WITHOUT_COMPILATION.
+#endif
+#if !defined(FORTH_EVAL_CACHE_SLOTS)
+#define FORTH_EVAL_CACHE_SLOTS 8				// The number of source strings kept in the evaluate cache.
+#endif
+#endif
+
 #if defined(FORTH_INCLUDE_LOCALS)
 #define FORTH_LOCALS_NAME_MAX_LENGTH 31
 #define FORTH_LOCALS_MAX_COUNT 16
@@ -87,6 +165,33 @@ typedef forth_ucell_t forth_cell_t;
 #define FORTH_LOCALS_WRITE_MASK    0x8000
 #endif
 
+#if defined(FORTH_INCLUDE_TASKS)
+#if !defined(FORTH_TASK_DATA_STACK_CELLS)
+#define FORTH_TASK_DATA_STACK_CELLS 32
+#endif
+#if !defined(FORTH_TASK_RETURN_STACK_CELLS)
+#define FORTH_TASK_RETURN_STACK_CELLS 32
+#endif
+#define FORTH_TASK_SEARCH_ORDER_SLOTS 8
+#endif
+
+#if defined(FORTH_INCLUDE_THREADS)
+#if !defined(FORTH_WORKER_DATA_STACK_CELLS)
+#define FORTH_WORKER_DATA_STACK_CELLS 128
+#endif
+#if !defined(FORTH_WORKER_RETURN_STACK_CELLS)
+#define FORTH_WORKER_RETURN_STACK_CELLS 128
+#endif
+#if !defined(FORTH_MAX_JOBS)
+#define FORTH_MAX_JOBS 64
+#endif
+#define FORTH_JOB_MAX_CELLS 8
+#define FORTH_WORKER_SEARCH_ORDER_SLOTS 8
+#if !defined(FORTH_PAR_MAX_CHUNKS)
+#define FORTH_PAR_MAX_CHUNKS 16
+#endif
+#endif
+
 #ifdef __cplusplus
 }
 #endif
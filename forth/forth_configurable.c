@@ -49,7 +49,63 @@ const forth_vocabulary_entry_t *forth_master_list_of_lists[] = {
     forth_wl_forth,
 #if defined(FORTH_INCLUDE_BLOCKS)
     forth_wl_blocks,
+#endif
+#if defined(FORTH_INCLUDE_TASKS)
+    forth_wl_tasks,
+#endif
+#if defined(FORTH_INCLUDE_THREADS)
+    forth_wl_threads,
+#endif
+#if defined(FORTH_INCLUDE_CHANNELS)
+    forth_wl_channels,
+#endif
+#if defined(FORTH_INCLUDE_ATOMICS)
+    forth_wl_atomics,
+#endif
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION)
+    forth_wl_memory,
+#endif
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+    forth_wl_files,
 #endif
     forth_wl_system,
     0
 };
+
+#if defined(FORTH_TOKEN_THREADED)
+// All arrays of compiled in words that threaded code can refer to, a token holds the index of the array in this list.
+// New arrays should be added at the end, so tokens of existing words do not change.
+const forth_vocabulary_entry_t *forth_token_tables[] = {
+    forth_wl_system,
+    forth_wl_token_support,
+    forth_wl_forth,
+    forth_wl_root,
+#if defined(FORTH_INCLUDE_LOCALS)
+    forth_wl_local_support,
+    forth_wl_local_variables,
+#endif
+#if defined(FORTH_INCLUDE_BLOCKS)
+    forth_wl_blocks,
+#endif
+#if defined(FORTH_INCLUDE_TASKS)
+    forth_wl_tasks,
+#endif
+#if defined(FORTH_INCLUDE_THREADS)
+    forth_wl_threads,
+    forth_wl_par_support,
+#endif
+#if defined(FORTH_INCLUDE_CHANNELS)
+    forth_wl_channels,
+#endif
+#if defined(FORTH_INCLUDE_ATOMICS)
+    forth_wl_atomics,
+#endif
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION)
+    forth_wl_memory,
+#endif
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+    forth_wl_files,
+#endif
+    0
+};
+#endif
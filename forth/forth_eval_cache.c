@@ -0,0 +1,262 @@
+/*
+* forth_eval_cache.c
+*
+*  Created on: Oct 18, 2026
+*      Author: Andras Zsoter
+*
+* Copyright (c) 2026 Andras Zsoter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+#include <forth.h>
+#include <forth_internal.h>
+#include <string.h>
+
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+// A cache of the names the text interpreter has parsed and resolved in the strings given to EVALUATE, EVALUATE-SCRIPT
+// and Forth(), so that interpreting the same string again does not have to parse and look them up.
+// A string is identified by its address, length and a hash of its contents. The names are only valid as long as no word
+// has been defined and the search order has not been changed (see FORTH_NAMES_CHANGED()).
+// A string is recorded when it is seen for the second time (a string that is only interpreted once should not evict
+// one that is interpreted over and over again), the tokens are replayed from the third time on.
+// The tokens remember where they have been found in the input, words that parse (S", CHAR, etc.) just move >IN past
+// what they have used and the interpreter carries on with the token found there. If there is none (e.g. [IF] has
+// skipped a different part of the input), the name is parsed as usual.
+// The cache is not thread safe, every context needs its own (see Forth_InitEvaluateCache()).
+
+// Initialize LENGTH bytes at ADDR to be used as an evaluate cache.
+forth_eval_cache_t *Forth_InitEvaluateCache(void *addr, forth_cell_t length)
+{
+	forth_eval_cache_t *cache = (forth_eval_cache_t *)FORTH_ALIGN(addr);
+	forth_cell_t limit = (((forth_cell_t)addr) + length) & FORTH_ALIGNED_MASK;
+	forth_eval_token_t *tokens = (forth_eval_token_t *)(cache + 1);
+	forth_cell_t i;
+
+	if ((0 == addr) || (limit < (((forth_cell_t)tokens) + (FORTH_EVAL_CACHE_SLOTS * sizeof(forth_eval_token_t)))))
+	{
+		return (forth_eval_cache_t *)0;
+	}
+
+	memset(cache, 0, sizeof(forth_eval_cache_t));
+	cache->capacity = (limit - (forth_cell_t)tokens) / (FORTH_EVAL_CACHE_SLOTS * sizeof(forth_eval_token_t));
+
+	for (i = 0; i < FORTH_EVAL_CACHE_SLOTS; i++)
+	{
+		cache->slots[i].tokens = tokens + (i * cache->capacity);
+	}
+
+	return cache;
+}
+
+// FNV-1a.
+static forth_cell_t forth_EVAL_HASH(const char *s, forth_cell_t length)
+{
+#if defined(FORTH_IS_64BIT)
+	forth_cell_t h = 0xcbf29ce484222325ULL;
+	const forth_cell_t prime = 0x100000001b3ULL;
+#else
+	forth_cell_t h = 0x811c9dc5UL;
+	const forth_cell_t prime = 0x01000193UL;
+#endif
+
+	while (0 != length--)
+	{
+		h = (h ^ (uint8_t)*s++) * prime;
+	}
+
+	return h;
+}
+
+// Stop using the cache for the rest of the source, a recording that has not been finished is dropped.
+static void forth_EVAL_CACHE_DROP(forth_eval_cursor_t *cursor)
+{
+	if (cursor->recording && (cursor->slot->version == cursor->version))
+	{
+		cursor->slot->count = 0;
+	}
+
+	cursor->slot = 0;
+}
+
+// Called by the text interpreter before it starts on the input source, decide whether the cache can be used.
+void forth_EVAL_CACHE_BEGIN(forth_runtime_context_t *ctx, forth_eval_cursor_t *cursor)
+{
+	forth_eval_slot_t *slot;
+	forth_cell_t address = (forth_cell_t)(ctx->source_address);
+	forth_cell_t hash;
+
+	cursor->slot = 0;
+
+	// Only strings, from the start.
+	if ((0 == ctx->eval_cache) || (0 == ctx->dictionary) || (0 <= (forth_scell_t)(ctx->source_id)) || (0 != ctx->blk)
+		|| (0 != ctx->to_in) || (0 == ctx->source_length))
+	{
+		return;
+	}
+
+	hash = forth_EVAL_HASH(ctx->source_address, ctx->source_length);
+	slot = &(ctx->eval_cache->slots[(hash ^ address ^ ctx->source_length) % FORTH_EVAL_CACHE_SLOTS]);
+
+	cursor->version = slot->version;
+	cursor->generation = ctx->dictionary->generation;
+	cursor->source = ctx->source_address;
+	cursor->line_no = ctx->line_no;
+	cursor->next = 0;
+
+	if ((address == slot->address) && (ctx->source_length == slot->length) && (hash == slot->hash))
+	{
+		if (slot->complete && (cursor->generation == slot->generation))
+		{
+			cursor->slot = slot;
+			cursor->recording = 0;
+			return;
+		}
+
+		// Seen before, record it.
+		slot->version++;
+		slot->generation = cursor->generation;
+		slot->complete = 0;
+		slot->count = 0;
+		cursor->version = slot->version;
+		cursor->slot = slot;
+		cursor->recording = 1;
+		return;
+	}
+
+	if (hash == slot->candidate)
+	{
+		// The second time, this string takes the slot.
+		slot->version++;
+		slot->address = address;
+		slot->length = ctx->source_length;
+		slot->hash = hash;
+		slot->generation = cursor->generation;
+		slot->complete = 0;
+		slot->count = 0;
+		cursor->version = slot->version;
+		cursor->slot = slot;
+		cursor->recording = 1;
+	}
+
+	slot->candidate = hash;
+}
+
+// Return the token recorded at >IN if it can be used instead of parsing the input, 0 otherwise.
+const forth_eval_token_t *forth_EVAL_CACHE_NEXT(forth_runtime_context_t *ctx, forth_eval_cursor_t *cursor)
+{
+	forth_eval_slot_t *slot = cursor->slot;
+	const forth_eval_token_t *token;
+
+	if ((0 == slot) || cursor->recording)
+	{
+		return (const forth_eval_token_t *)0;
+	}
+
+	if (slot->version != cursor->version)
+	{
+		cursor->slot = 0;	// The slot has been taken by another string (e.g. by a nested EVALUATE).
+		return (const forth_eval_token_t *)0;
+	}
+
+	while ((cursor->next < slot->count) && (slot->tokens[cursor->next].from < ctx->to_in))
+	{
+		cursor->next++;
+	}
+
+	if ((cursor->next >= slot->count) || (slot->tokens[cursor->next].from != ctx->to_in))
+	{
+		return (const forth_eval_token_t *)0;
+	}
+
+	token = &(slot->tokens[cursor->next]);
+
+	if ((FORTH_EVAL_TOKEN_LIVE == token->kind) || ((FORTH_EVAL_TOKEN_XT < token->kind) && (token->base != ctx->base)))
+	{
+		return (const forth_eval_token_t *)0;
+	}
+
+#if defined(FORTH_INCLUDE_LOCALS)
+	if ((0 != ctx->state) && (0 != ctx->dictionary->local_count))
+	{
+		return (const forth_eval_token_t *)0;	// A local variable might hide it.
+	}
+#endif
+
+	cursor->next++;
+	return token;
+}
+
+// Record what the name parsed from FROM has been resolved to.
+// For numbers X and HIGH are taken from the stack as left there by forth_PROCESS_NUMBER().
+void forth_EVAL_CACHE_RECORD(forth_runtime_context_t *ctx, forth_eval_cursor_t *cursor, forth_cell_t from, forth_cell_t kind, forth_cell_t x)
+{
+	forth_eval_slot_t *slot = cursor->slot;
+	forth_eval_token_t *token;
+
+	if ((0 == slot) || !cursor->recording)
+	{
+		return;
+	}
+
+	if ((slot->version != cursor->version) || (slot->count >= ctx->eval_cache->capacity))
+	{
+		forth_EVAL_CACHE_DROP(cursor);
+		return;
+	}
+
+	token = &(slot->tokens[slot->count]);
+	token->from = from;
+	token->to = ctx->to_in;
+	token->line = ctx->line_no - cursor->line_no;
+	token->kind = kind;
+	token->x = x;
+	token->high = 0;
+	token->base = ctx->base;
+
+	if (FORTH_EVAL_TOKEN_SINGLE == kind)
+	{
+		token->x = ctx->sp[1];
+	}
+	else if (FORTH_EVAL_TOKEN_DOUBLE == kind)
+	{
+		token->x = ctx->sp[2];
+		token->high = ctx->sp[1];
+	}
+
+	slot->count++;
+
+	if (FORTH_EVAL_TOKEN_END == kind)
+	{
+		slot->complete = 1;
+		cursor->slot = 0;
+	}
+}
+
+// Called after a word has been executed or compiled, the tokens are no longer valid if it has changed what the names
+// mean or the input source.
+void forth_EVAL_CACHE_CHECK(forth_runtime_context_t *ctx, forth_eval_cursor_t *cursor)
+{
+	if ((0 != cursor->slot) && ((ctx->dictionary->generation != cursor->generation) || (ctx->source_address != cursor->source)))
+	{
+		forth_EVAL_CACHE_DROP(cursor);
+	}
+}
+#endif
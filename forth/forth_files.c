@@ -0,0 +1,491 @@
+/*
+* forth_files.c
+*
+*  Created on: Oct 18, 2026
+*      Author: Andras Zsoter
+*
+* Copyright (c) 2026 Andras Zsoter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+#include <forth.h>
+#include <forth_internal.h>
+#include <string.h>
+
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+// The file access word set on top of the file system provided by the application (see forth_file_ops_t).
+// INCLUDE-FILE interprets a file a line at a time: each line is read into the file input buffer of the cold context
+// by REFILL, so a script of any size can be interpreted without holding it in memory.
+// Nested files share the buffer, when a file is done the line of the file that has included it is read again
+// (from source_file_position). A file that cannot tell its position (a pipe) can be interpreted, but not include others.
+// If the file system can map a file in memory the whole file becomes the input source instead (like a multi-line
+// EVALUATE), nothing is copied and SOURCE and >IN cover the whole file.
+
+// Return the file system of CTX, throw if there is none.
+static const forth_file_ops_t *forth_FILE_OPS(forth_runtime_context_t *ctx)
+{
+	if (0 == ctx->file_ops)
+	{
+		forth_THROW(ctx, -21); // Unsupported operation.
+	}
+
+	return ctx->file_ops;
+}
+
+// Read the next line of the file being interpreted (SOURCE-ID) into the file input buffer.
+// Return 0 at the end of the file, throw -18 if the line is longer than FORTH_FILE_INPUT_BUFFER_LENGTH.
+int forth_REFILL_FILE(forth_runtime_context_t *ctx)
+{
+	const forth_file_ops_t *ops = forth_FILE_OPS(ctx);
+	forth_cell_t count = 0;
+	forth_cell_t found = 0;
+	forth_dcell_t position = 0;
+	forth_scell_t ior;
+
+	if (0 != ctx->cold->including_mapped)
+	{
+		// The input source is the whole file already, skip to the next line.
+		const char *eol = (ctx->to_in < ctx->source_length) ? (const char *)memchr(ctx->source_address + ctx->to_in, '\n', ctx->source_length - ctx->to_in) : 0;
+
+		ctx->to_in = (0 != eol) ? (forth_cell_t)(eol + 1 - ctx->source_address) : ctx->source_length;
+		ctx->line_no += (0 != eol) ? 1 : 0;
+		return (ctx->to_in < ctx->source_length) ? 1 : 0;
+	}
+
+	// The position is only needed to read the line again after a nested INCLUDE-FILE.
+	ior = ops->position(ctx, ctx->source_id, &position);
+	ctx->cold->source_file_position = (0 == ior) ? (forth_cell_t)position : FORTH_UNKNOWN_FILE_POSITION;
+
+	// Reading one more character than fits tells a line that is too long from one that is just long enough.
+	ior = ops->read_line(ctx, ctx->source_id, ctx->cold->file_buffer, FORTH_FILE_INPUT_BUFFER_LENGTH + 1, &count, &found);
+
+	if (0 != ior)
+	{
+		forth_THROW(ctx, ior);
+	}
+
+	if (0 == found)
+	{
+		return 0;
+	}
+
+	ctx->source_address = ctx->cold->file_buffer;
+	ctx->source_length = count;
+	ctx->to_in = 0;
+	ctx->line_no++;
+
+	if (FORTH_FILE_INPUT_BUFFER_LENGTH < count)
+	{
+		ctx->source_length = 0;	// None of it is interpreted.
+		forth_THROW(ctx, -18);	// Parsed string overflow.
+	}
+
+	return 1;
+}
+
+// Read the line of FILEID at POSITION into the file input buffer again (the file being included has used it).
+static forth_scell_t forth_RESTORE_FILE_LINE(forth_runtime_context_t *ctx, forth_cell_t fileid, forth_dcell_t position)
+{
+	const forth_file_ops_t *ops = ctx->file_ops;
+	forth_cell_t count = 0;
+	forth_cell_t found = 0;
+	forth_scell_t ior;
+
+	if (FORTH_UNKNOWN_FILE_POSITION == position)
+	{
+		return -37; // File I/O exception -- the rest of the line is lost.
+	}
+
+	ior = ops->reposition(ctx, fileid, position);
+
+	if (0 == ior)
+	{
+		ior = ops->read_line(ctx, fileid, ctx->cold->file_buffer, FORTH_FILE_INPUT_BUFFER_LENGTH + 1, &count, &found);
+	}
+
+	return ((0 == ior) && (0 == found)) ? -37 : ior; // File I/O exception.
+}
+
+// If the error location refers to SOURCE (the file input buffer, which is about to be overwritten, or a mapping about
+// to be released) keep the name of the word.
+static void forth_KEEP_ERROR_NAME(forth_runtime_context_t *ctx, const char *source)
+{
+	forth_cold_context_t *cold = ctx->cold;
+	const char *end;
+	const char *start;
+
+	if (cold->error_source != source)
+	{
+		return;
+	}
+
+	end = source + ((cold->error_position < cold->error_source_length) ? cold->error_position : cold->error_source_length);
+
+	while ((end > source) && ((unsigned char)(end[-1]) <= FORTH_CHAR_SPACE))
+	{
+		end--;
+	}
+
+	for (start = end; (start > source) && ((unsigned char)(start[-1]) > FORTH_CHAR_SPACE) && ((end - start) < FORTH_ERROR_NAME_LENGTH); start--)
+	{
+	}
+
+	memcpy(cold->error_name, start, end - start);
+	cold->error_source = cold->error_name;
+	cold->error_source_length = end - start;
+	cold->error_position = end - start;
+}
+
+// Interpret FILEID a line at a time, close it when done (even if an exception is thrown) and restore the input source.
+static void forth_INCLUDE_FILE(forth_runtime_context_t *ctx, forth_cell_t fileid)
+{
+	const forth_file_ops_t *ops = forth_FILE_OPS(ctx);
+	forth_scell_t res;
+	forth_scell_t ior;
+	forth_cell_t saved_source_id = ctx->source_id;
+	forth_cell_t saved_blk = ctx->blk;
+	forth_cell_t saved_in = ctx->to_in;
+	forth_cell_t saved_line_no = ctx->line_no;
+	const char *saved_source_address = ctx->source_address;
+	forth_cell_t saved_source_length = ctx->source_length;
+	forth_cell_t saved_including = ctx->cold->including;
+	forth_cell_t saved_position = ctx->cold->source_file_position;
+	forth_cell_t saved_mapped = ctx->cold->including_mapped;
+	const char *mapping = 0;
+	forth_cell_t mapping_length = 0;
+
+	if ((0 == fileid) || ((forth_cell_t)-1 == fileid) || ((forth_cell_t)-2 == fileid))
+	{
+		forth_THROW(ctx, -38); // Non-existent file.
+	}
+
+	if (0 == ctx->cold->input_buffers)
+	{
+		(void)ops->close(ctx, fileid);
+		forth_THROW(ctx, -21); // Unsupported operation -- a task has no file input buffer.
+	}
+
+	ctx->source_id = fileid;
+	ctx->blk = 0;
+	ctx->source_address = ctx->cold->file_buffer;
+	ctx->source_length = 0;
+	ctx->to_in = 0;
+	ctx->line_no = (forth_cell_t)-1;	// REFILL counts the first line too.
+	ctx->cold->including = fileid;
+	ctx->cold->including_mapped = 0;
+
+	if ((0 != ops->map) && (0 == ops->map(ctx, fileid, &mapping, &mapping_length)))
+	{
+		ctx->source_address = mapping;
+		ctx->source_length = mapping_length;
+		ctx->line_no = 0;
+		ctx->cold->including_mapped = 1;
+		res = forth_CATCH(ctx, forth_interpret_xt);
+	}
+	else
+	{
+		mapping = 0;
+		res = forth_CATCH(ctx, forth_include_lines_xt);
+	}
+
+	if ((0 != res) && ((0 != mapping) || (0 != saved_including)))
+	{
+		forth_KEEP_ERROR_NAME(ctx, (0 != mapping) ? mapping : ctx->cold->file_buffer);
+	}
+
+	if (0 != mapping)
+	{
+		ior = ops->unmap(ctx, fileid, mapping, mapping_length);
+		res = (0 != res) ? res : ior;
+	}
+
+	ior = ops->close(ctx, fileid);
+	res = (0 != res) ? res : ior;
+
+	if ((0 != saved_including) && (0 == saved_mapped) && (0 == mapping))
+	{
+		// The file input buffer has been used by the included file.
+		ior = forth_RESTORE_FILE_LINE(ctx, saved_including, saved_position);
+		res = (0 != res) ? res : ior;
+	}
+
+	ctx->cold->including = saved_including;
+	ctx->cold->including_mapped = saved_mapped;
+	ctx->cold->source_file_position = saved_position;
+	ctx->source_id = saved_source_id;
+	ctx->blk = saved_blk;
+	ctx->to_in = saved_in;
+	ctx->line_no = saved_line_no;
+	ctx->source_address = saved_source_address;
+	ctx->source_length = saved_source_length;
+#if defined(FORTH_INCLUDE_BLOCKS)
+	if (0 != saved_blk)
+	{
+		forth_ADJUST_BLK_INPUT_SOURCE(ctx, saved_blk);
+	}
+#endif
+	forth_RETHROW(ctx, res);
+}
+
+// (INCLUDE-LINES) ( -- )
+// Interpret the rest of the file that is the input source.
+void forth_paren_include_lines(forth_runtime_context_t *ctx)
+{
+	while (forth_REFILL_FILE(ctx))
+	{
+		forth_interpret(ctx);
+	}
+}
+
+// Open the file named by NAME and LENGTH with FAM, push fileid and ior.
+static void forth_OPEN(forth_runtime_context_t *ctx, forth_cell_t create)
+{
+	const forth_file_ops_t *ops = forth_FILE_OPS(ctx);
+	forth_cell_t fam = forth_POP(ctx);
+	forth_cell_t length = forth_POP(ctx);
+	const char *name = (const char *)forth_POP(ctx);
+	forth_cell_t fileid = 0;
+	forth_scell_t ior;
+
+	ior = create ? ops->create(ctx, name, length, fam, &fileid) : ops->open(ctx, name, length, fam, &fileid);
+	forth_PUSH(ctx, (0 == ior) ? fileid : 0);
+	forth_PUSH(ctx, ior);
+}
+
+// R/O ( -- fam )
+void forth_r_o(forth_runtime_context_t *ctx)
+{
+	forth_PUSH(ctx, FORTH_FAM_READ);
+}
+
+// W/O ( -- fam )
+void forth_w_o(forth_runtime_context_t *ctx)
+{
+	forth_PUSH(ctx, FORTH_FAM_WRITE);
+}
+
+// R/W ( -- fam )
+void forth_r_w(forth_runtime_context_t *ctx)
+{
+	forth_PUSH(ctx, FORTH_FAM_READ | FORTH_FAM_WRITE);
+}
+
+// BIN ( fam1 -- fam2 )
+void forth_bin(forth_runtime_context_t *ctx)
+{
+	forth_PUSH(ctx, forth_POP(ctx) | FORTH_FAM_BIN);
+}
+
+// OPEN-FILE ( c-addr u fam -- fileid ior )
+void forth_open_file(forth_runtime_context_t *ctx)
+{
+	forth_OPEN(ctx, 0);
+}
+
+// CREATE-FILE ( c-addr u fam -- fileid ior )
+void forth_create_file(forth_runtime_context_t *ctx)
+{
+	forth_OPEN(ctx, 1);
+}
+
+// CLOSE-FILE ( fileid -- ior )
+void forth_close_file(forth_runtime_context_t *ctx)
+{
+	const forth_file_ops_t *ops = forth_FILE_OPS(ctx);
+	forth_cell_t fileid = forth_POP(ctx);
+
+	forth_PUSH(ctx, ops->close(ctx, fileid));
+}
+
+// READ-FILE ( c-addr u1 fileid -- u2 ior )
+void forth_read_file(forth_runtime_context_t *ctx)
+{
+	const forth_file_ops_t *ops = forth_FILE_OPS(ctx);
+	forth_cell_t fileid = forth_POP(ctx);
+	forth_cell_t length = forth_POP(ctx);
+	char *buffer = (char *)forth_POP(ctx);
+	forth_cell_t count = 0;
+	forth_scell_t ior;
+
+	ior = ops->read(ctx, fileid, buffer, length, &count);
+	forth_PUSH(ctx, count);
+	forth_PUSH(ctx, ior);
+}
+
+// READ-LINE ( c-addr u1 fileid -- u2 flag ior )
+void forth_read_line(forth_runtime_context_t *ctx)
+{
+	const forth_file_ops_t *ops = forth_FILE_OPS(ctx);
+	forth_cell_t fileid = forth_POP(ctx);
+	forth_cell_t length = forth_POP(ctx);
+	char *buffer = (char *)forth_POP(ctx);
+	forth_cell_t count = 0;
+	forth_cell_t found = 0;
+	forth_scell_t ior;
+
+	ior = ops->read_line(ctx, fileid, buffer, length, &count, &found);
+	forth_PUSH(ctx, count);
+	forth_PUSH(ctx, ((0 == ior) && (0 != found)) ? FORTH_TRUE : FORTH_FALSE);
+	forth_PUSH(ctx, ior);
+}
+
+// WRITE-FILE ( c-addr u fileid -- ior )
+void forth_write_file(forth_runtime_context_t *ctx)
+{
+	const forth_file_ops_t *ops = forth_FILE_OPS(ctx);
+	forth_cell_t fileid = forth_POP(ctx);
+	forth_cell_t length = forth_POP(ctx);
+	const char *buffer = (const char *)forth_POP(ctx);
+
+	forth_PUSH(ctx, ops->write(ctx, fileid, buffer, length));
+}
+
+// WRITE-LINE ( c-addr u fileid -- ior )
+void forth_write_line(forth_runtime_context_t *ctx)
+{
+	const forth_file_ops_t *ops = forth_FILE_OPS(ctx);
+	forth_cell_t fileid = forth_POP(ctx);
+	forth_cell_t length = forth_POP(ctx);
+	const char *buffer = (const char *)forth_POP(ctx);
+	forth_scell_t ior;
+
+	ior = ops->write(ctx, fileid, buffer, length);
+
+	if (0 == ior)
+	{
+		ior = ops->write(ctx, fileid, "\n", 1);
+	}
+
+	forth_PUSH(ctx, ior);
+}
+
+// FILE-POSITION ( fileid -- ud ior )
+void forth_file_position(forth_runtime_context_t *ctx)
+{
+	const forth_file_ops_t *ops = forth_FILE_OPS(ctx);
+	forth_cell_t fileid = forth_POP(ctx);
+	forth_dcell_t position = 0;
+	forth_scell_t ior;
+
+	ior = ops->position(ctx, fileid, &position);
+	forth_DPUSH(ctx, position);
+	forth_PUSH(ctx, ior);
+}
+
+// REPOSITION-FILE ( ud fileid -- ior )
+void forth_reposition_file(forth_runtime_context_t *ctx)
+{
+	const forth_file_ops_t *ops = forth_FILE_OPS(ctx);
+	forth_cell_t fileid = forth_POP(ctx);
+	forth_dcell_t position = forth_DPOP(ctx);
+
+	forth_PUSH(ctx, ops->reposition(ctx, fileid, position));
+}
+
+// FILE-SIZE ( fileid -- ud ior )
+void forth_file_size(forth_runtime_context_t *ctx)
+{
+	const forth_file_ops_t *ops = forth_FILE_OPS(ctx);
+	forth_cell_t fileid = forth_POP(ctx);
+	forth_dcell_t size = 0;
+	forth_scell_t ior;
+
+	ior = ops->size(ctx, fileid, &size);
+	forth_DPUSH(ctx, size);
+	forth_PUSH(ctx, ior);
+}
+
+// FLUSH-FILE ( fileid -- ior )
+void forth_flush_file(forth_runtime_context_t *ctx)
+{
+	const forth_file_ops_t *ops = forth_FILE_OPS(ctx);
+	forth_cell_t fileid = forth_POP(ctx);
+
+	forth_PUSH(ctx, ops->flush(ctx, fileid));
+}
+
+// DELETE-FILE ( c-addr u -- ior )
+void forth_delete_file(forth_runtime_context_t *ctx)
+{
+	const forth_file_ops_t *ops = forth_FILE_OPS(ctx);
+	forth_cell_t length = forth_POP(ctx);
+	const char *name = (const char *)forth_POP(ctx);
+
+	forth_PUSH(ctx, ops->remove(ctx, name, length));
+}
+
+// INCLUDE-FILE ( i * x fileid -- j * x )
+void forth_include_file(forth_runtime_context_t *ctx)
+{
+	forth_INCLUDE_FILE(ctx, forth_POP(ctx));
+}
+
+// INCLUDED ( i * x c-addr u -- j * x )
+void forth_included(forth_runtime_context_t *ctx)
+{
+	forth_scell_t ior;
+
+	forth_PUSH(ctx, FORTH_FAM_READ);
+	forth_OPEN(ctx, 0);
+	ior = (forth_scell_t)forth_POP(ctx);
+
+	if (0 != ior)
+	{
+		forth_THROW(ctx, ior);
+	}
+
+	forth_INCLUDE_FILE(ctx, forth_POP(ctx));
+}
+
+// INCLUDE ( i * x "name" -- j * x )
+void forth_include(forth_runtime_context_t *ctx)
+{
+	forth_parse_name(ctx);
+	forth_included(ctx);
+}
+
+const forth_vocabulary_entry_t forth_wl_files[] =
+{
+DEF_FORTH_WORD( "(include-lines)",	0, forth_paren_include_lines,	"( -- )"),
+DEF_FORTH_WORD( "r/o",  			0, forth_r_o,   			"( -- fam )"),
+DEF_FORTH_WORD( "w/o",  			0, forth_w_o,   			"( -- fam )"),
+DEF_FORTH_WORD( "r/w",  			0, forth_r_w,   			"( -- fam )"),
+DEF_FORTH_WORD( "bin",  			0, forth_bin,   			"( fam1 -- fam2 )"),
+DEF_FORTH_WORD( "open-file",  		0, forth_open_file,   		"( c-addr u fam -- fileid ior )"),
+DEF_FORTH_WORD( "create-file",  	0, forth_create_file,   	"( c-addr u fam -- fileid ior )"),
+DEF_FORTH_WORD( "close-file",  		0, forth_close_file,   		"( fileid -- ior )"),
+DEF_FORTH_WORD( "read-file",  		0, forth_read_file,   		"( c-addr u1 fileid -- u2 ior )"),
+DEF_FORTH_WORD( "read-line",  		0, forth_read_line,   		"( c-addr u1 fileid -- u2 flag ior )"),
+DEF_FORTH_WORD( "write-file",  		0, forth_write_file,   		"( c-addr u fileid -- ior )"),
+DEF_FORTH_WORD( "write-line",  		0, forth_write_line,   		"( c-addr u fileid -- ior )"),
+DEF_FORTH_WORD( "file-position",  	0, forth_file_position,   	"( fileid -- ud ior )"),
+DEF_FORTH_WORD( "reposition-file",	0, forth_reposition_file,	"( ud fileid -- ior )"),
+DEF_FORTH_WORD( "file-size",  		0, forth_file_size,   		"( fileid -- ud ior )"),
+DEF_FORTH_WORD( "flush-file",  		0, forth_flush_file,   		"( fileid -- ior )"),
+DEF_FORTH_WORD( "delete-file",  	0, forth_delete_file,   	"( c-addr u -- ior )"),
+DEF_FORTH_WORD( "include-file",  	0, forth_include_file,   	"( i * x fileid -- j * x )"),
+DEF_FORTH_WORD( "included",  		0, forth_included,   		"( i * x c-addr u -- j * x )"),
+DEF_FORTH_WORD( "include",  		0, forth_include,   		"( i * x \"name\" -- j * x )"),
+DEF_FORTH_WORD(0, 0, 0, 0)
+};
+
+const forth_xt_t forth_include_lines_xt = (const forth_xt_t)&(forth_wl_files[0]);
+#endif
@@ -32,6 +32,7 @@
 #include <forth_config.h>
 #include <forth.h>
 #include <setjmp.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -44,18 +45,55 @@ extern "C" {
 #define FORTH_CHAR_SPACE 0x20
 
 // A vocabulary entry (word header) which is also used as an XT (execution token) in this implementation.
+// With FORTH_COMPACT_HEADERS (or FORTH_SEPARATE_HEADS) the flags are next to the meaning, since the definitions created
+// at runtime only have these two cells (see FORTH_XT_FLAGS_COMPACT), the name and link of such an entry overlap
+// whatever precedes it.
 struct forth_vocabulary_entry_struct
 {
     forth_cell_t name;
+#if defined(FORTH_ONE_CELL_HEADERS)
+	forth_cell_t link;
+	forth_ucell_t flags;
+#else
 	forth_ucell_t flags;
 	forth_cell_t link;
+#endif
     forth_ucell_t meaning;
 };
 
 typedef struct forth_vocabulary_entry_struct forth_vocabulary_entry_t;
 typedef forth_vocabulary_entry_t *forth_xt_t;
 
+#if defined(FORTH_TOKEN_THREADED)
+// Threaded code is made of 32 bit tokens instead of cells. An even token is the offset of the xt from the dictionary
+// (in units of tokens), an odd one identifies a word compiled in C that is too far from the dictionary by the number
+// of its array (in forth_token_tables) and its index there. 0 is still EXIT.
+// Inline operands (literals, offsets, etc.) are tokens, too, see forth_XT_TO_TOKEN() and forth_LITERAL(), but
+// headers and strings inside threaded code start at cell boundaries.
+typedef uint32_t forth_token_t;
+typedef int32_t forth_stoken_t;
+#define FORTH_TOKEN_TABLE_SHIFT	11
+#define FORTH_TOKEN_INDEX_MASK	0x3FF
+#define FORTH_TOKEN_ALIGN(X) ((((forth_ucell_t)(X)) + (sizeof(forth_token_t) - 1)) & ~(sizeof(forth_token_t) - 1))
+#define forth_TOKEN_TO_XT(CTX, T) ((0 != ((T) & 1)) \
+	? (forth_xt_t)(forth_token_tables[(T) >> FORTH_TOKEN_TABLE_SHIFT] + (((T) >> 1) & FORTH_TOKEN_INDEX_MASK)) \
+	: (forth_xt_t)(((uint8_t *)((CTX)->dictionary)) + (((forth_scell_t)(forth_stoken_t)(T)) * (forth_scell_t)sizeof(forth_token_t))))
+extern const forth_vocabulary_entry_t *forth_token_tables[];
+extern const forth_vocabulary_entry_t forth_wl_token_support[];
+#else
+typedef forth_cell_t forth_token_t;
+typedef forth_scell_t forth_stoken_t;
+#define FORTH_TOKEN_ALIGN(X) FORTH_ALIGN(X)
+#define forth_TOKEN_TO_XT(CTX, T) ((forth_xt_t)(T))
+#endif
+
+#if defined(FORTH_ONE_CELL_HEADERS)
 #if defined(FORTH_EXCLUDE_DESCRIPTIONS)
+#define DEF_FORTH_WORD(N, F, M, D)	{ (forth_cell_t)N, (forth_cell_t)0, F, (forth_ucell_t)M }
+#else
+#define DEF_FORTH_WORD(N, F, M, D)	{ (forth_cell_t)N, (forth_cell_t)D, F, (forth_ucell_t)M }
+#endif
+#elif defined(FORTH_EXCLUDE_DESCRIPTIONS)
 #define DEF_FORTH_WORD(N, F, M, D)	{ (forth_cell_t)N, F, (forth_ucell_t)0, (forth_ucell_t)M }
 #else
 #define DEF_FORTH_WORD(N, F, M, D)	{ (forth_cell_t)N, F, (forth_ucell_t)D, (forth_ucell_t)M }
@@ -77,6 +115,43 @@ typedef forth_vocabulary_entry_t *forth_xt_t;
 #define FORTH_XT_FLAGS_ACTION_2VARIABLE	0x09
 #define FORTH_XT_FLAGS_ACTION_2VALUE	0x0a
 
+#if defined(FORTH_ONE_CELL_HEADERS)
+#define FORTH_XT_FLAGS_COMPACT 			0x20
+#define FORTH_XT_FLAGS_MASK				0xff
+#define FORTH_HEADER_CELLS 1
+#define FORTH_SET_XT_FLAGS(E, F) ((E)->flags = ((E)->flags & ~(forth_ucell_t)FORTH_XT_FLAGS_MASK) | FORTH_XT_FLAGS_COMPACT | (F))
+#else
+#define FORTH_HEADER_CELLS 3
+#define FORTH_SET_XT_FLAGS(E, F) ((E)->flags = (F))
+#endif
+
+#if defined(FORTH_COMPACT_HEADERS)
+// A header created at runtime is a single cell: the flags (bits 0..7), the length of the name (bits 8..15) and the
+// distance of the previous entry of the word list in cells (bits 16..31, 0 is the end of the list).
+// The name (terminated by 0) is in the cells right before it, the words compiled in C keep the usual format.
+#define FORTH_COMPACT_NAME_MAX_LENGTH	0xff
+#define FORTH_COMPACT_LINK_MAX			0xffff
+#define FORTH_COMPACT_NAME_LENGTH(E)	(((E)->flags >> 8) & FORTH_COMPACT_NAME_MAX_LENGTH)
+#define FORTH_COMPACT_LINK(E)			(((E)->flags >> 16) & FORTH_COMPACT_LINK_MAX)
+#define FORTH_ENTRY_NAME(E) ((0 == ((E)->flags & FORTH_XT_FLAGS_COMPACT)) ? (const char *)((E)->name) \
+	: (0 == FORTH_COMPACT_NAME_LENGTH(E)) ? "" : ((const char *)&((E)->flags)) - FORTH_ALIGN(FORTH_COMPACT_NAME_LENGTH(E) + 1))
+#define FORTH_ENTRY_LINK(E) ((0 == ((E)->flags & FORTH_XT_FLAGS_COMPACT)) ? (forth_vocabulary_entry_t *)((E)->link) \
+	: (0 == FORTH_COMPACT_LINK(E)) ? (forth_vocabulary_entry_t *)0 : (forth_vocabulary_entry_t *)(((forth_cell_t *)(E)) - FORTH_COMPACT_LINK(E)))
+#elif defined(FORTH_SEPARATE_HEADS)
+// Only the flags of a header created at runtime are in the code space, the rest of the cell (bits 8 and up) is the
+// distance in cells of its head (the link followed by the name terminated by 0) in the head space, 0 if it is nameless.
+#define FORTH_HEAD(E) (((forth_cell_t *)(E)) + ((E)->flags >> 8))
+#define FORTH_ENTRY_NAME(E) ((0 == ((E)->flags & FORTH_XT_FLAGS_COMPACT)) ? (const char *)((E)->name) \
+	: (0 == ((E)->flags >> 8)) ? "" : (const char *)(FORTH_HEAD(E) + 1))
+#define FORTH_ENTRY_LINK(E) ((0 == ((E)->flags & FORTH_XT_FLAGS_COMPACT)) ? (forth_vocabulary_entry_t *)((E)->link) \
+	: (0 == ((E)->flags >> 8)) ? (forth_vocabulary_entry_t *)0 : (forth_vocabulary_entry_t *)(FORTH_HEAD(E)[0]))
+#else
+#define FORTH_ENTRY_NAME(E) ((const char *)((E)->name))
+#define FORTH_ENTRY_LINK(E) ((forth_vocabulary_entry_t *)((E)->link))
+#endif
+// The xt of a nameless header laid down at address A by forth_NAMELESS_HEADER().
+#define FORTH_HEADER_XT(A) ((forth_xt_t)(((forth_cell_t *)(A)) + FORTH_HEADER_CELLS - 3))
+
 #if defined(FORTH_INCLUDE_LOCALS)
 
 #endif
@@ -95,14 +170,31 @@ typedef struct forth_wordlist_s forth_wordlist_t;
 // The structure of the forth dictionary area.
 struct forth_dictionary
 {
-	forth_ucell_t	 dp;			// An index to items.
+	forth_ucell_t	 dp;			// An index to items (or to the current segment).
 	forth_ucell_t	 dp_max;		// Max value of dp.
+#if defined(FORTH_SEPARATE_HEADS)
+	forth_ucell_t	 heads;			// The end of the head space, which starts at dp_max.
+#endif
+#if defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+	forth_cell_t	 segment;		// The segment dp is an index to (items, until the first one is full).
+	forth_segment_provider_t more;	// Supplies the next segment when the current one is full (0 if none).
+#endif
 	forth_wordlist_t forth_wl;  	// FORTH-WORDLIST
 	forth_cell_t	 last_wordlist;	// Link to the most recently defined wordlist.
 #if defined(FORTH_INCLUDE_LOCALS)
 	forth_cell_t 	local_count;	// The number of local variables in the current definition.
 	// We need an area to store the names of local variables during compilation, this is as good a spot as any.
 	char local_names[FORTH_LOCALS_MAX_COUNT][FORTH_LOCALS_NAME_MAX_LENGTH+1];
+#endif
+#if defined(FORTH_INCLUDE_TASKS)
+	forth_cell_t	tasks;			// The most recently created task (see TASK).
+	forth_cell_t	current_task;	// The task being run by the scheduler (0 if none).
+#endif
+#if defined(FORTH_INCLUDE_THREADS)
+	forth_cell_t	workers;		// The worker pool (see Forth_StartWorkers()).
+#endif
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+	forth_cell_t	generation;		// Changes whenever a name may have got a new meaning (see FORTH_NAMES_CHANGED()).
 #endif
 	uint8_t 		 items[1];		// Place holder for the rest of the dictionary.
 };
@@ -148,55 +240,110 @@ extern void forth_edit(forth_runtime_context_t *ctx);
 
 #endif
 
+// The rarely used part of the runtime context: buffers, error reporting and the state of an interrupted Forth_Feed() session.
+// It is allocated separately (see forth_context_init_data_t), so the part the interpreter works with stays small.
+struct forth_cold_context
+{
+	forth_cell_t	abort_msg_len;			// Used by ABORT"
+	forth_cell_t	abort_msg_addr;			// Used by ABORT"
+	const char		*error_source;			// The input source when the last exception was thrown (see forth_THROW()).
+	forth_cell_t	error_source_length;	// Used by error reporting.
+	forth_cell_t	error_blk;				// Used by error reporting.
+	forth_cell_t	error_position;			// Used by error reporting.
+	forth_cell_t	error_line;				// Used by error reporting.
+	forth_scell_t	error_source_id;		// Used by error reporting.
+	forth_cell_t	session_line;			// Forth_Feed() has been suspended while interpreting the line in the TIB.
+	const char		*feed_address;			// The input given to Forth_Feed() that has not been used yet.
+	forth_cell_t	feed_length;
+	forth_cell_t	feed_pending;			// The length of the incomplete line already read (see forth_ACCEPT_LINE()).
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+	forth_cell_t	including;				// The innermost file being interpreted by INCLUDE-FILE (0 if none).
+	forth_cell_t	including_mapped;		// Non-zero if that file is mapped in memory (the input source is the whole file).
+	forth_cell_t	source_file_position;	// The position of the line in the file input buffer (a cell: tasks are only cell aligned).
+#define FORTH_UNKNOWN_FILE_POSITION ((forth_cell_t)-1)	// The file cannot tell its position (e.g. a pipe).
+#endif
+#if defined(FORTH_INCLUDE_OUTPUT_CAPTURE)
+	forth_cell_t	capturing;				// Non-zero while Forth_RunCapture() is running.
+	char			*capture_address;		// The buffer given to Forth_RunCapture()...
+	forth_cell_t	capture_capacity;
+	forth_cell_t	capture_used;			// ...and the number of characters in it.
+	forth_cell_t	capture_length;			// All the characters captured (including the spill).
+	forth_capture_chunk_t *capture_spill;	// The output that did not fit in the buffer.
+	forth_capture_chunk_t *capture_last;
+	forth_heap_t   *capture_heap;			// The heap the spill has been allocated from.
+#endif
+#if defined(FORTH_INCLUDE_OUTPUT_BUFFER)
+	forth_cell_t	output_count;			// The output not yet given to the output device (see forth_WRITE_STRING()).
+	forth_cell_t	output_failed;			// Writing the buffer has failed since the application last called in.
+	char output_buffer[FORTH_OUTPUT_BUFFER_LENGTH];
+#endif
+	char 	       *numbuff_ptr;						// The current position in the number conversion buffer.
+	char		    num_buff[FORTH_NUM_BUFF_LENGTH];	// The number conversion buffer.
+	forth_cell_t	tib_count;							// The number of characters in the terminal input buffer.
+	forth_cell_t	input_buffers;						// Non-zero if the cold block has the input buffers below.
+	// The input buffers must be the last fields: the cold block of a task ends before them (see FORTH_TASK_COLD_CELLS).
+	char		    tib[FORTH_TIB_SIZE];				// The terminal input buffer.
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+	char file_buffer[FORTH_FILE_INPUT_BUFFER_LENGTH + 1];	// One more to tell a line that does not fit (see forth_REFILL_FILE()).
+	char error_name[FORTH_ERROR_NAME_LENGTH];	// The word where an included file has failed (see forth_INCLUDE_FILE()).
+#endif
+};
+
 // The runtime context passed to each and every function implementing a forth word.
+// The fields used by almost every instruction come first, so they share one or two cache lines.
 struct forth_runtime_context
 {
-	forth_dictionary_t *dictionary;
-#if defined(FORTH_INCLUDE_BLOCKS)
-	forth_block_buffers_t	*block_buffers;
-#endif
-	forth_cell_t	*sp_max;				// The maximum value of the data stack pointer.
-	forth_cell_t	*sp_min;				// The minimum value of the data stack pointer.
-	forth_cell_t	*sp0;					// The default value of the data stack pointer (should be sp_max).
+	forth_token_t	*ip;					// The Instruction Pointer (IP) of the threaded code interpreter.
 	forth_cell_t	*sp;					// The current value of the data stack pointer.
-	forth_cell_t	*rp_max;				// The maximum value of the return stack pointer.
-	forth_cell_t	*rp_min;				// The minimum value of the return stack pointer.
-	forth_cell_t	*rp0;					// The default value of the return stack pointer (should be rp_max).
+	forth_cell_t	*sp_min;				// The minimum value of the data stack pointer.
+	forth_cell_t	*sp_max;				// The maximum value of the data stack pointer.
 	forth_cell_t	*rp;					// The current value of the return stack pointer.
-	forth_cell_t	*ip;					// The Instruction Pointer (IP) of the threaded code interpreter.
+	forth_cell_t	*rp_min;				// The minimum value of the return stack pointer.
+	forth_cell_t	*rp_max;				// The maximum value of the return stack pointer.
+	forth_cell_t	steps_left;				// The remaining instruction budget (0 means no limit), see Forth_RunWithBudget().
+	forth_cell_t	trace;					// Flag for Enabling/disabling execution trace.
+	forth_cell_t	user_break;				// The user has pressed CTRL-C.....
+	forth_cell_t	nesting;				// The number of C functions running the interpreter, they cannot be suspended.
 #if defined(FORTH_INCLUDE_LOCALS)
 	forth_cell_t	*fp;					// Frame Pointer for implementing local variables.
 #endif
-	forth_cell_t	base;					// Numeric base (Forth: BASE).
-	forth_cell_t	state;					// Compilation state (Forth: STATE).
 	forth_cell_t	throw_handler;			// Handler for CATCH and THROW.
+	forth_dictionary_t *dictionary;
+	forth_cell_t	state;					// Compilation state (Forth: STATE).
+	forth_cell_t	base;					// Numeric base (Forth: BASE).
+	// End of the hot part.
+	forth_cell_t	*sp0;					// The default value of the data stack pointer (should be sp_max).
+	forth_cell_t	*rp0;					// The default value of the return stack pointer (should be rp_max).
 	forth_cell_t	bye_handler;			// Handler for Bye (because of the mixed threaded and native code).
 	forth_cell_t	quit_handler;			// Handler for QUIT (also because of the mixed threaded and native code.)
-	forth_cell_t	user_break;				// The user has pressed CTRL-C.....
-	forth_cell_t	abort_msg_len;			// Used by ABORT"
-	forth_cell_t	abort_msg_addr;			// Used by ABORT"
-	forth_cell_t	symbol_addr;			// Used by error reporting.
-	forth_cell_t	symbol_length;			// Used by error reporting.
-	forth_cell_t	symbol_blk;				// Used by error reporting.
-	forth_cell_t	symbol_position;		// Used by error reporting.
-	forth_cell_t	symbol_line;			// Used by error reporting.
-	forth_scell_t	symbol_source_id;		// Used by error reporting.
+	forth_cell_t	suspend_handler;		// Handler for suspending the interpreter when the instruction budget runs out.
+#if defined(FORTH_INCLUDE_THREADS)
+	forth_cell_t	dictionary_frozen;		// A worker thread, it must not change the shared dictionary.
+#endif
+#if defined(FORTH_INCLUDE_BLOCKS)
+	forth_block_buffers_t	*block_buffers;
+#endif
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION)
+	forth_heap_t	*heap;					// Used by ALLOCATE, etc. (see Forth_InitHeap()).
+#endif
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+	const forth_file_ops_t *file_ops;		// Used by the file access words (0 if there is no file system).
+#endif
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+	forth_eval_cache_t *eval_cache;			// Names already resolved in the strings interpreted (see Forth_InitEvaluateCache()).
+#endif
 	forth_cell_t	blk;					// Forth: BLK
 	forth_cell_t	source_id;				// Forth: SOURCE-ID
 	const char		*source_address;		// Used by SOURCE.
 	forth_cell_t	source_length;			// Used by SOURCE.
 	forth_cell_t	to_in;					// Forth: >IN
 	forth_cell_t	line_no;				// Line number for files scripts, etc.
-#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
-	forth_dcell_t	source_file_position;
-	char file_buffer[FORTH_FILE_INPUT_BUFFER_LENGTH];
-#endif
 	forth_cell_t	*wordlists;				// Wordlists in the search order.
 	forth_cell_t	wordlist_slots;			// The number of slots in the search order.
 	forth_cell_t	wordlist_cnt;			// The number of workdlists in the search order.
 	forth_cell_t	current;				// The current wordlist (where definitions are appended).
 	forth_cell_t	defining;				// The word being defined.
-	forth_cell_t	trace;					// Flag for Enabling/disabling execution trace.
+	forth_cold_context_t *cold;				// The rarely used part of the context.
 	forth_cell_t	terminal_width;			// Terminal width -- i.e. number of columns (mandatory).
 	forth_cell_t	terminal_height;		// Terminal height -- i.e. number of rows (mandatory.)
 	forth_cell_t	terminal_col;			// Current column of the terminal output.
@@ -210,16 +357,134 @@ struct forth_runtime_context
 	forth_cell_t (*ekey)(struct forth_runtime_context *rctx);				// The implementation of EKEY (Can be set to 0)
 	forth_cell_t (*ekey_q)(struct forth_runtime_context *rctx);				// The implementation of EKEY? (Can be set to 0)
 	forth_cell_t (*ekey_to_char)(struct forth_runtime_context *rctx, forth_cell_t ekey); // The implementation of EKEY>CHAR (Can be set to 0.)
-	forth_cell_t	tib_count;							// The number of characters in the terminal input buffer.
-	char		    tib[FORTH_TIB_SIZE];				// The terminal input buffer.
-	char 	       *numbuff_ptr;						// The current position in the number conversion buffer.	
-	char		    num_buff[FORTH_NUM_BUFF_LENGTH];	// The number conversion buffer.
-	//char		    internal_buffer[32];
+	int (*pause)(struct forth_runtime_context *rctx);						// Called by PAUSE and by blocking words to let the application's scheduler run (Can be set to 0.)
 #if defined(FORTH_APPLICATION_DEFINED_CONTEXT_FIELDS)
 	FORTH_APPLICATION_DEFINED_CONTEXT_FIELDS
 #endif
 };
 
+#if defined(FORTH_INCLUDE_TASKS)
+#define FORTH_TASK_ASLEEP	0
+#define FORTH_TASK_AWAKE	1
+
+// A task has no terminal or file input of its own, so its cold block stops before the input buffers.
+#define FORTH_TASK_COLD_CELLS	((offsetof(forth_cold_context_t, tib) + sizeof(forth_cell_t) - 1) / sizeof(forth_cell_t))
+
+// A task created by TASK in the dictionary, it has its own context and stacks but shares the dictionary.
+struct forth_task
+{
+	forth_cell_t			link;		// The previously created task.
+	forth_cell_t			status;		// FORTH_TASK_ASLEEP or FORTH_TASK_AWAKE.
+	forth_runtime_context_t	ctx;
+	forth_cell_t			data_stack[FORTH_TASK_DATA_STACK_CELLS];
+	forth_cell_t			return_stack[FORTH_TASK_RETURN_STACK_CELLS];
+	forth_cell_t			search_order[FORTH_TASK_SEARCH_ORDER_SLOTS];
+	forth_cell_t			cold[FORTH_TASK_COLD_CELLS];	// The head of a forth_cold_context_t (input_buffers is 0).
+};
+typedef struct forth_task forth_task_t;
+
+extern const forth_vocabulary_entry_t forth_wl_tasks[];
+extern void forth_pause(forth_runtime_context_t *ctx);
+#endif
+
+#if defined(FORTH_INCLUDE_CHANNELS)
+extern const forth_vocabulary_entry_t forth_wl_channels[];
+#endif
+
+#if defined(FORTH_INCLUDE_ATOMICS)
+extern const forth_vocabulary_entry_t forth_wl_atomics[];
+#endif
+
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION)
+// See forth_memory.c.
+struct forth_heap
+{
+	forth_cell_t	base;			// The start of the region (after this structure).
+	forth_cell_t	limit;			// The end of the region.
+	forth_cell_t	top;			// Blocks are carved from the region at this address (it grows upwards).
+	forth_cell_t	arena;			// The scratch arena is [arena, limit) (it grows downwards).
+	forth_cell_t	live;			// The number of bytes in allocated blocks.
+	forth_cell_t	free_large;		// Free blocks too big for the size classes, in address order.
+	forth_cell_t	free_small[FORTH_HEAP_SIZE_CLASSES];	// The free lists of the size classes.
+};
+
+extern void *forth_HEAP_ALLOCATE(forth_heap_t *heap, forth_cell_t size);
+extern forth_scell_t forth_HEAP_FREE(forth_heap_t *heap, forth_cell_t addr);
+extern const forth_vocabulary_entry_t forth_wl_memory[];
+#endif
+
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+extern int forth_REFILL_FILE(forth_runtime_context_t *ctx);
+extern const forth_xt_t forth_include_lines_xt;
+extern const forth_vocabulary_entry_t forth_wl_files[];
+#endif
+
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+// See forth_eval_cache.c.
+#define FORTH_EVAL_TOKEN_END	0	// The end of the input.
+#define FORTH_EVAL_TOKEN_LIVE	1	// The name has to be looked up every time (e.g. it was a local variable).
+#define FORTH_EVAL_TOKEN_XT		2
+#define FORTH_EVAL_TOKEN_SINGLE	3
+#define FORTH_EVAL_TOKEN_DOUBLE	4
+
+// A name parsed by the text interpreter and what it has been resolved to.
+struct forth_eval_token
+{
+	forth_cell_t	from;			// >IN before the name was parsed.
+	forth_cell_t	to;				// >IN after it.
+	forth_cell_t	line;			// The number of lines from the beginning of the source.
+	forth_cell_t	kind;			// FORTH_EVAL_TOKEN_...
+	forth_cell_t	x;				// The xt or the number (the low cell of a double).
+	forth_cell_t	high;			// The high cell of a double.
+	forth_cell_t	base;			// The base a number was converted in.
+};
+typedef struct forth_eval_token forth_eval_token_t;
+
+// The tokens of a source string.
+struct forth_eval_slot
+{
+	forth_cell_t	address;
+	forth_cell_t	length;
+	forth_cell_t	hash;			// Of the contents.
+	forth_cell_t	generation;		// See the dictionary.
+	forth_cell_t	complete;		// All tokens have been recorded.
+	forth_cell_t	count;			// The number of tokens.
+	forth_cell_t	version;		// Incremented when the slot is recorded again (perhaps for another string).
+	forth_cell_t	candidate;		// The hash of the last string that has not been recorded yet.
+	forth_eval_token_t *tokens;
+};
+typedef struct forth_eval_slot forth_eval_slot_t;
+
+struct forth_eval_cache
+{
+	forth_cell_t	capacity;		// The number of tokens in a slot.
+	forth_eval_slot_t slots[FORTH_EVAL_CACHE_SLOTS];
+};
+
+// How the text interpreter is using the cache for the current input source.
+struct forth_eval_cursor
+{
+	forth_eval_slot_t *slot;		// 0 if the cache is not used.
+	forth_cell_t	version;		// Of the slot when it was picked.
+	forth_cell_t	recording;
+	forth_cell_t	next;			// The index of the next token to replay.
+	forth_cell_t	generation;
+	forth_cell_t	line_no;		// At the start of the source.
+	const char		*source;
+};
+typedef struct forth_eval_cursor forth_eval_cursor_t;
+
+extern void forth_EVAL_CACHE_BEGIN(forth_runtime_context_t *ctx, forth_eval_cursor_t *cursor);
+extern const forth_eval_token_t *forth_EVAL_CACHE_NEXT(forth_runtime_context_t *ctx, forth_eval_cursor_t *cursor);
+extern void forth_EVAL_CACHE_RECORD(forth_runtime_context_t *ctx, forth_eval_cursor_t *cursor, forth_cell_t from, forth_cell_t kind, forth_cell_t x);
+extern void forth_EVAL_CACHE_CHECK(forth_runtime_context_t *ctx, forth_eval_cursor_t *cursor);
+
+// Names resolved earlier might mean something else after a definition or a change of the search order.
+#define FORTH_NAMES_CHANGED(CTX) ((CTX)->dictionary->generation++)
+#else
+#define FORTH_NAMES_CHANGED(CTX)
+#endif
+
 #define FORTH_COLON_SYS_MARKER	0x4e4c4f43
 #define FORTH_DEST_MARKER 		0x54534544
 #define FORTH_ORIG_MARKER		0x4749524F
@@ -241,6 +506,9 @@ extern const forth_xt_t forth_type_xt;
 extern const forth_xt_t forth_COMPILE_COMMA_xt;
 extern const forth_xt_t forth_LIT_xt;
 extern const forth_xt_t forth_XLIT_xt;
+#if defined(FORTH_TOKEN_THREADED)
+extern const forth_xt_t forth_WLIT_xt;
+#endif
 extern const forth_xt_t forth_SLIT_xt;
 extern const forth_xt_t forth_BRANCH_xt;
 extern const forth_xt_t forth_0BRANCH_xt;
@@ -252,6 +520,9 @@ extern const forth_xt_t forth_pDOES_xt;
 extern const forth_xt_t forth_pABORTq_xt;
 extern const forth_xt_t forth_DO_VOC_xt;
 extern const forth_xt_t forth_TO_RT_xt;
+#if defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+extern const forth_xt_t forth_SEGMENT_BRANCH_xt;
+#endif
 
 extern int forth_InitSearchOrder(forth_runtime_context_t *ctx, forth_cell_t *wordlists, forth_cell_t slots);
 extern void forth_forth_wordlist(forth_runtime_context_t *ctx);
@@ -274,6 +545,7 @@ extern int forth_HDOT(forth_runtime_context_t *ctx, forth_cell_t value);
 extern int forth_UDOT(forth_runtime_context_t *ctx, forth_cell_t base, forth_cell_t value);
 extern int forth_DOT(forth_runtime_context_t *ctx, forth_cell_t base, forth_cell_t value);
 extern int forth_DOT_R(forth_runtime_context_t *ctx, forth_cell_t base, forth_cell_t value, forth_cell_t width, forth_cell_t is_signed);
+extern int forth_PROCESS_NUMBER(forth_runtime_context_t *ctx, const char *buff, forth_cell_t len);
 
 extern void forth_PRINT_TRACE(forth_runtime_context_t *ctx, forth_xt_t xt);
 extern void forth_EXECUTE(forth_runtime_context_t *ctx, forth_xt_t xt);
@@ -281,12 +553,18 @@ extern forth_scell_t forth_CATCH(forth_runtime_context_t *ctx, forth_xt_t xt);
 extern forth_scell_t forth_RUN_INTERPRET(forth_runtime_context_t *ctx);
 extern void forth_PRINT_ERROR(forth_runtime_context_t *ctx, forth_scell_t code);
 extern forth_vocabulary_entry_t *forth_CREATE_DICTIONARY_ENTRY(forth_runtime_context_t *ctx);
+extern forth_vocabulary_entry_t *forth_PARSE_NAME_AND_CREATE_ENTRY(forth_runtime_context_t *ctx);
 extern int forth_COMPARE_NAMES(const char *name, const char *input_word, int input_word_length);
 
+extern const forth_vocabulary_entry_t *forth_FIND_NAME(struct forth_runtime_context *ctx, const char *name, forth_cell_t len);
 extern const forth_vocabulary_entry_t *forth_SEARCH_COMPILED_IN_LIST(const forth_vocabulary_entry_t *list, const char *name, int name_length);
 
 extern void forth_CHECK_STACK_AT_LEAST(forth_runtime_context_t *ctx, forth_cell_t n);
 extern void forth_THROW(forth_runtime_context_t *ctx, forth_scell_t code);
+extern void forth_RETHROW(forth_runtime_context_t *ctx, forth_scell_t code);
+#if defined(FORTH_GUARDED_STACKS)
+extern void forth_GUARDED_STACK_FAULT(forth_runtime_context_t *ctx, const void *addr, forth_cell_t guard_size);
+#endif
 extern void forth_PUSH(forth_runtime_context_t *ctx, forth_ucell_t x);
 extern forth_cell_t forth_POP(forth_runtime_context_t *ctx);
 extern forth_dcell_t forth_DTOS_READ(forth_runtime_context_t *ctx);
@@ -298,8 +576,29 @@ extern forth_cell_t forth_RPOP(forth_runtime_context_t *ctx);
 #if !defined(FORTH_WITHOUT_COMPILATION)
 extern forth_vocabulary_entry_t *forth_GET_LATEST(forth_runtime_context_t *ctx);
 extern void forth_SET_LATEST(forth_runtime_context_t *ctx, forth_vocabulary_entry_t *token);
+extern forth_vocabulary_entry_t *forth_NAMELESS_HEADER(forth_runtime_context_t *ctx);
+#if defined(FORTH_ONE_CELL_HEADERS)
+extern void forth_SET_LINK(forth_runtime_context_t *ctx, forth_vocabulary_entry_t *entry, const forth_vocabulary_entry_t *link);
+#else
+#define forth_SET_LINK(CTX, E, L) ((E)->link = (forth_cell_t)(L))
+#endif
 extern void forth_COMMA(forth_runtime_context_t *ctx, forth_cell_t x);
-#define forth_COMPILE_COMMA(CTX , XT) forth_COMMA((CTX), (forth_cell_t)(XT))
+extern void forth_LITERAL(forth_runtime_context_t *ctx, forth_cell_t x);
+#if defined(FORTH_TOKEN_THREADED)
+extern forth_token_t forth_XT_TO_TOKEN(forth_runtime_context_t *ctx, forth_xt_t xt);
+extern void forth_TOKEN_COMMA(forth_runtime_context_t *ctx, forth_token_t t);
+#else
+#define forth_XT_TO_TOKEN(CTX, XT) ((forth_token_t)(XT))
+#define forth_TOKEN_COMMA(CTX, T) forth_COMMA((CTX), (forth_cell_t)(T))
+#endif
+#if defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+extern void forth_ROOM(forth_runtime_context_t *ctx, forth_cell_t n);
+#define FORTH_DICTIONARY_ITEMS(DICT) ((uint8_t *)((DICT)->segment))
+#define forth_COMPILE_COMMA(CTX , XT) (forth_ROOM((CTX), FORTH_SEGMENT_COMPILE_ROOM), forth_TOKEN_COMMA((CTX), forth_XT_TO_TOKEN((CTX), (forth_xt_t)(XT))))
+#else
+#define FORTH_DICTIONARY_ITEMS(DICT) ((DICT)->items)
+#define forth_COMPILE_COMMA(CTX , XT) forth_TOKEN_COMMA((CTX), forth_XT_TO_TOKEN((CTX), (forth_xt_t)(XT)))
+#endif
 
 #if defined(FORTH_INCLUDE_LOCALS)
 extern void forth_paren_local(forth_runtime_context_t *ctx); // (LOCAL)
@@ -310,14 +609,61 @@ extern const forth_vocabulary_entry_t *forth_find_local(forth_runtime_context_t
 extern const forth_xt_t forth_init_locals_xt;
 extern const forth_xt_t forth_uninitialized_locals_xt;
 extern const forth_xt_t forth_alloca_runtime_xt;
+extern const forth_vocabulary_entry_t forth_wl_local_support[];
+extern const forth_vocabulary_entry_t forth_wl_local_variables[];
 #endif
 
 #endif
 
 extern void forth_TYPE0(forth_runtime_context_t *ctx, const char *str);
 extern void forth_EMIT(forth_runtime_context_t *ctx, char c);
+extern int forth_WRITE_STRING(forth_runtime_context_t *ctx, const char *str, forth_cell_t length);
+extern int forth_SEND_CR(forth_runtime_context_t *ctx);
+#if defined(FORTH_INCLUDE_OUTPUT_BUFFER)
+extern int forth_FLUSH_OUTPUT(forth_runtime_context_t *ctx);
+extern forth_scell_t forth_FLUSH_ON_RETURN(forth_runtime_context_t *ctx, forth_scell_t res);
+// The output still in the buffer is on the current line too.
+#define FORTH_TERMINAL_COL(CTX) ((CTX)->terminal_col + (CTX)->cold->output_count)
+#else
+#define forth_FLUSH_OUTPUT(CTX) 0
+#define forth_FLUSH_ON_RETURN(CTX, RES) (RES)
+#define FORTH_TERMINAL_COL(CTX) ((CTX)->terminal_col)
+#endif
 
 extern void forth_InnerInterpreter(forth_runtime_context_t *ctx, forth_xt_t xt);
+extern void forth_NEST(forth_runtime_context_t *ctx, forth_xt_t xt);
+extern void forth_UNNEST(forth_runtime_context_t *ctx);
+extern void forth_RUN_THREADED(forth_runtime_context_t *ctx);
+extern void forth_OUT_OF_STEPS(forth_runtime_context_t *ctx, forth_cell_t level);
+extern void forth_WAIT_FOR_INPUT(forth_runtime_context_t *ctx, forth_behavior_t f);
+
+// Values passed to longjmp() when leaving the interpreter.
+#define FORTH_EXIT_BYE				(-1)
+#define FORTH_EXIT_OUT_OF_STEPS		1
+#define FORTH_EXIT_WOULD_BLOCK		2
+#define FORTH_EXIT_PAUSE			3
+
+extern forth_scell_t forth_RUN_RESUMABLE(forth_runtime_context_t *ctx, forth_cell_t max_steps);
+extern void forth_INHERIT_DEVICES(forth_runtime_context_t *ctx, const forth_runtime_context_t *parent);
+
+#if defined(FORTH_INCLUDE_THREADS)
+// Worker threads share the dictionary of their creator, they must not change it.
+#define FORTH_CHECK_DICTIONARY_FROZEN(CTX) \
+	do { if (0 != (CTX)->dictionary_frozen) forth_THROW((CTX), -21); } while (0)
+
+extern const forth_vocabulary_entry_t forth_wl_threads[];
+extern const forth_xt_t forth_pPAR_DO_xt;
+extern const forth_xt_t forth_pPAR_LOOP_xt;
+extern const forth_vocabulary_entry_t forth_wl_par_support[];
+
+#define FORTH_PAR_MARKER		0x52415070
+#else
+#define FORTH_CHECK_DICTIONARY_FROZEN(CTX)
+#endif
+
+// Count a step against the instruction budget, LEVEL is the nesting where the interpreter can be suspended.
+#define FORTH_COUNT_STEP(CTX, LEVEL) \
+	do { if ((0 != (CTX)->steps_left) && (0 == --((CTX)->steps_left))) forth_OUT_OF_STEPS((CTX), (LEVEL)); } while (0)
 extern void forth_DoConst(forth_runtime_context_t *ctx, forth_xt_t xt);
 extern void forth_DoConst2(forth_runtime_context_t *ctx, forth_xt_t xt);
 extern void forth_DoVar(forth_runtime_context_t *ctx, forth_xt_t xt);
@@ -341,6 +687,7 @@ extern void forth_print_version(forth_runtime_context_t *ctx);
 extern void forth_type(forth_runtime_context_t *ctx);
 extern void forth_emit(forth_runtime_context_t *ctx);
 extern void forth_cr(forth_runtime_context_t *ctx);
+extern void forth_flush_output(forth_runtime_context_t *ctx);
 extern void forth_at_xy(forth_runtime_context_t *ctx);
 extern void forth_page(forth_runtime_context_t *ctx);
 
@@ -523,6 +870,7 @@ extern void forth_align(forth_runtime_context_t *ctx);
 extern void forth_allot(forth_runtime_context_t *ctx);
 extern void forth_c_comma(forth_runtime_context_t *ctx); 			// C,
 extern void forth_comma(forth_runtime_context_t *ctx);	 			// ,
+extern void forth_compile_comma(forth_runtime_context_t *ctx);		// COMPILE,
 extern void forth_postpone(forth_runtime_context_t *ctx);			// POSTPONE
 #endif
 
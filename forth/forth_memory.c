@@ -0,0 +1,418 @@
+/*
+* forth_memory.c
+*
+*  Created on: Oct 18, 2026
+*      Author: Andras Zsoter
+*
+* Copyright (c) 2026 Andras Zsoter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+#include <forth.h>
+#include <forth_internal.h>
+#include <string.h>
+
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION)
+// The memory-allocation word set (ALLOCATE, FREE, RESIZE) working on a region of memory given by the application,
+// so it does not need malloc().
+// Small blocks come from slabs (a slab is carved from the region and cut up into blocks of the same size class),
+// bigger blocks are carved from the region and kept on an address ordered free list (neighbours are merged) when freed.
+// Scratch memory (ARENA-ALLOCATE) is taken from the other end of the region and released in bulk with ARENA-RELEASE.
+// Each block is preceded by a cell holding its size in bytes, the lowest bit of which is set while the block is free.
+// The heap is not thread safe, worker threads do not get it.
+
+#define FORTH_HEAP_FREE_BIT	((forth_cell_t)1)
+#define FORTH_HEAP_CLASS_SIZE(C) ((FORTH_HEAP_SMALLEST_CLASS_CELLS * sizeof(forth_cell_t)) << (C))
+#define FORTH_HEAP_LARGEST_CLASS_SIZE FORTH_HEAP_CLASS_SIZE(FORTH_HEAP_SIZE_CLASSES - 1)
+
+// Initialize LENGTH bytes at ADDR to be used as a heap.
+forth_heap_t *Forth_InitHeap(void *addr, forth_cell_t length)
+{
+	forth_heap_t *heap = (forth_heap_t *)FORTH_ALIGN(addr);
+	forth_cell_t limit = (((forth_cell_t)addr) + length) & FORTH_ALIGNED_MASK;
+
+	if ((0 == addr) || (limit < (((forth_cell_t)heap) + sizeof(forth_heap_t))))
+	{
+		return (forth_heap_t *)0;
+	}
+
+	memset(heap, 0, sizeof(forth_heap_t));
+	heap->base = FORTH_ALIGN(heap + 1);
+	heap->limit = limit;
+	heap->top = heap->base;
+	heap->arena = limit;
+
+	return heap;
+}
+
+// Return the size class of blocks with SIZE bytes, FORTH_HEAP_SIZE_CLASSES if they are too big for a size class.
+static forth_cell_t forth_HEAP_CLASS(forth_cell_t size)
+{
+	forth_cell_t c;
+
+	for (c = 0; c < FORTH_HEAP_SIZE_CLASSES; c++)
+	{
+		if (size <= FORTH_HEAP_CLASS_SIZE(c))
+		{
+			break;
+		}
+	}
+
+	return c;
+}
+
+// Take LENGTH bytes from the free space between the blocks and the arena, return 0 if there is not enough.
+static forth_cell_t *forth_HEAP_CARVE(forth_heap_t *heap, forth_cell_t length)
+{
+	forth_cell_t *p = (forth_cell_t *)(heap->top);
+
+	if (length > (heap->arena - heap->top))
+	{
+		return 0;
+	}
+
+	heap->top += length;
+	return p;
+}
+
+// Cut a new slab into blocks of size class C and put them on the free list of the class.
+static void forth_HEAP_REFILL(forth_heap_t *heap, forth_cell_t c)
+{
+	forth_cell_t size = FORTH_HEAP_CLASS_SIZE(c);
+	forth_cell_t block = sizeof(forth_cell_t) + size;
+	forth_cell_t count = (FORTH_HEAP_SLAB_SIZE > block) ? (FORTH_HEAP_SLAB_SIZE / block) : 1;
+	forth_cell_t *p = forth_HEAP_CARVE(heap, count * block);
+
+	if (0 == p)
+	{
+		count = 1;
+		p = forth_HEAP_CARVE(heap, block);
+	}
+
+	for (; (0 != p) && (0 != count); count--)
+	{
+		p[0] = size | FORTH_HEAP_FREE_BIT;
+		p[1] = heap->free_small[c];
+		heap->free_small[c] = (forth_cell_t)p;
+		p = (forth_cell_t *)(((uint8_t *)p) + block);
+	}
+}
+
+// Return a block of at least SIZE bytes, 0 if there is not enough memory.
+void *forth_HEAP_ALLOCATE(forth_heap_t *heap, forth_cell_t size)
+{
+	forth_cell_t c;
+	forth_cell_t *p;
+	forth_cell_t *prev;
+	forth_cell_t *split;
+	forth_cell_t rest;
+
+	if (size > (heap->limit - heap->base))
+	{
+		return 0;
+	}
+
+	size = FORTH_ALIGN((0 == size) ? 1 : size);
+	c = forth_HEAP_CLASS(size);
+
+	if (FORTH_HEAP_SIZE_CLASSES > c)
+	{
+		if (0 == heap->free_small[c])
+		{
+			forth_HEAP_REFILL(heap, c);
+		}
+
+		p = (forth_cell_t *)(heap->free_small[c]);
+
+		if (0 == p)
+		{
+			return 0;
+		}
+
+		heap->free_small[c] = p[1];
+	}
+	else
+	{
+		// First fit from the free list, the rest of the block is split off if it is still big.
+		for (prev = &(heap->free_large), p = (forth_cell_t *)*prev; 0 != p; prev = &(p[1]), p = (forth_cell_t *)*prev)
+		{
+			if (size <= (p[0] & ~FORTH_HEAP_FREE_BIT))
+			{
+				break;
+			}
+		}
+
+		if (0 != p)
+		{
+			rest = (p[0] & ~FORTH_HEAP_FREE_BIT) - size;
+
+			if (rest > (sizeof(forth_cell_t) + FORTH_HEAP_LARGEST_CLASS_SIZE))
+			{
+				// The rest takes the place of the block on the list, so the list stays in address order.
+				p[0] = size;
+				split = (forth_cell_t *)(((uint8_t *)(p + 1)) + size);
+				split[0] = (rest - sizeof(forth_cell_t)) | FORTH_HEAP_FREE_BIT;
+				split[1] = p[1];
+				*prev = (forth_cell_t)split;
+			}
+			else
+			{
+				*prev = p[1];
+			}
+		}
+		else
+		{
+			p = forth_HEAP_CARVE(heap, sizeof(forth_cell_t) + size);
+
+			if (0 == p)
+			{
+				return 0;
+			}
+
+			p[0] = size;
+		}
+	}
+
+	p[0] &= ~FORTH_HEAP_FREE_BIT;
+	heap->live += p[0];
+	return p + 1;
+}
+
+// Return the header of the block at ADDR, 0 if ADDR is not an allocated block of HEAP.
+static forth_cell_t *forth_HEAP_BLOCK(forth_heap_t *heap, forth_cell_t addr)
+{
+	forth_cell_t *p;
+	forth_cell_t size;
+
+	// Checked before forming the header address, which would wrap around for an ADDR near 0.
+	if ((0 != (addr & ~FORTH_ALIGNED_MASK)) || (addr < (heap->base + sizeof(forth_cell_t))) || (addr >= heap->top))
+	{
+		return 0;
+	}
+
+	p = ((forth_cell_t *)addr) - 1;
+
+	size = p[0];
+
+	if ((0 == size) || (0 != (size & ~FORTH_ALIGNED_MASK)) || (size > (heap->top - addr)))
+	{
+		return 0; // Free (or not a block at all).
+	}
+
+	return p;
+}
+
+// Put the big block P on the free list, merge it with its free neighbours and give it back to the region if it is at the top.
+static void forth_HEAP_RELEASE_LARGE(forth_heap_t *heap, forth_cell_t *p)
+{
+	forth_cell_t *prev;
+	forth_cell_t *next;
+	forth_cell_t *before = 0;
+	forth_cell_t size = p[0];
+
+	for (prev = &(heap->free_large), next = (forth_cell_t *)*prev; (0 != next) && (next < p); prev = &(next[1]), next = (forth_cell_t *)*prev)
+	{
+		before = next;
+	}
+
+	if ((0 != next) && ((((uint8_t *)(p + 1)) + size) == (uint8_t *)next))
+	{
+		size += sizeof(forth_cell_t) + (next[0] & ~FORTH_HEAP_FREE_BIT);
+		next = (forth_cell_t *)(next[1]);
+	}
+
+	p[0] = size | FORTH_HEAP_FREE_BIT;
+	p[1] = (forth_cell_t)next;
+	*prev = (forth_cell_t)p;
+
+	if ((0 != before) && ((((uint8_t *)(before + 1)) + (before[0] & ~FORTH_HEAP_FREE_BIT)) == (uint8_t *)p))
+	{
+		before[0] = ((before[0] & ~FORTH_HEAP_FREE_BIT) + sizeof(forth_cell_t) + size) | FORTH_HEAP_FREE_BIT;
+		before[1] = p[1];
+		p = before;
+	}
+
+	if ((((forth_cell_t)(p + 1)) + (p[0] & ~FORTH_HEAP_FREE_BIT)) == heap->top)
+	{
+		// It is the last block on the list.
+		for (prev = &(heap->free_large); (forth_cell_t)p != *prev; prev = &(((forth_cell_t *)*prev)[1]))
+		{
+		}
+
+		*prev = 0;
+		heap->top = (forth_cell_t)p;
+	}
+}
+
+// Free the block at ADDR, return 0 or the I/O result code for FREE.
+forth_scell_t forth_HEAP_FREE(forth_heap_t *heap, forth_cell_t addr)
+{
+	forth_cell_t *p = forth_HEAP_BLOCK(heap, addr);
+	forth_cell_t c;
+
+	if (0 == p)
+	{
+		return -60; // FREE
+	}
+
+	heap->live -= p[0];
+	c = forth_HEAP_CLASS(p[0]);
+
+	if (FORTH_HEAP_SIZE_CLASSES > c)
+	{
+		p[0] |= FORTH_HEAP_FREE_BIT;
+		p[1] = heap->free_small[c];
+		heap->free_small[c] = (forth_cell_t)p;
+	}
+	else
+	{
+		forth_HEAP_RELEASE_LARGE(heap, p);
+	}
+
+	return 0;
+}
+
+// ALLOCATE ( u -- a-addr ior )
+void forth_allocate(forth_runtime_context_t *ctx)
+{
+	forth_cell_t size = forth_POP(ctx);
+	void *addr = (0 != ctx->heap) ? forth_HEAP_ALLOCATE(ctx->heap, size) : 0;
+
+	forth_PUSH(ctx, (forth_cell_t)addr);
+	forth_PUSH(ctx, (0 != addr) ? 0 : (forth_cell_t)-59); // ALLOCATE
+}
+
+// FREE ( a-addr -- ior )
+void forth_free(forth_runtime_context_t *ctx)
+{
+	forth_cell_t addr = forth_POP(ctx);
+
+	forth_PUSH(ctx, (0 != ctx->heap) ? (forth_cell_t)forth_HEAP_FREE(ctx->heap, addr) : (forth_cell_t)-60);
+}
+
+// RESIZE ( a-addr1 u -- a-addr2 ior )
+// Blocks never shrink, a bigger block is a new one (unless there is already room in the old one).
+void forth_resize(forth_runtime_context_t *ctx)
+{
+	forth_cell_t size = forth_POP(ctx);
+	forth_cell_t addr = forth_POP(ctx);
+	forth_cell_t *p;
+	void *new_addr;
+
+	if (0 == ctx->heap)
+	{
+		forth_PUSH(ctx, addr);
+		forth_PUSH(ctx, (forth_cell_t)-61); // RESIZE
+		return;
+	}
+
+	if (0 == addr)
+	{
+		forth_PUSH(ctx, size);
+		forth_allocate(ctx);
+		return;
+	}
+
+	p = forth_HEAP_BLOCK(ctx->heap, addr);
+
+	if ((0 != p) && (size <= p[0]))
+	{
+		forth_PUSH(ctx, addr);
+		forth_PUSH(ctx, 0);
+		return;
+	}
+
+	new_addr = (0 != p) ? forth_HEAP_ALLOCATE(ctx->heap, size) : 0;
+
+	if (0 == new_addr)
+	{
+		forth_PUSH(ctx, addr);
+		forth_PUSH(ctx, (forth_cell_t)-61); // RESIZE
+		return;
+	}
+
+	memcpy(new_addr, (void *)addr, p[0]);
+	(void)forth_HEAP_FREE(ctx->heap, addr);
+	forth_PUSH(ctx, (forth_cell_t)new_addr);
+	forth_PUSH(ctx, 0);
+}
+
+static forth_heap_t *forth_ARENA(forth_runtime_context_t *ctx)
+{
+	if (0 == ctx->heap)
+	{
+		forth_THROW(ctx, -21); // Unsupported operation.
+	}
+
+	return ctx->heap;
+}
+
+// ARENA-MARK ( -- mark )
+void forth_arena_mark(forth_runtime_context_t *ctx)
+{
+	forth_PUSH(ctx, forth_ARENA(ctx)->arena);
+}
+
+// ARENA-ALLOCATE ( u -- a-addr ior )
+// Scratch memory, it is not freed individually but all at once by ARENA-RELEASE.
+void forth_arena_allocate(forth_runtime_context_t *ctx)
+{
+	forth_heap_t *heap = forth_ARENA(ctx);
+	forth_cell_t size = forth_POP(ctx);
+
+	if (size > (heap->arena - heap->top))
+	{
+		forth_PUSH(ctx, 0);
+		forth_PUSH(ctx, (forth_cell_t)-59); // ALLOCATE
+		return;
+	}
+
+	heap->arena -= FORTH_ALIGN(size);
+	forth_PUSH(ctx, heap->arena);
+	forth_PUSH(ctx, 0);
+}
+
+// ARENA-RELEASE ( mark -- )
+// Free everything ARENA-ALLOCATE has given out since ARENA-MARK returned MARK.
+void forth_arena_release(forth_runtime_context_t *ctx)
+{
+	forth_heap_t *heap = forth_ARENA(ctx);
+	forth_cell_t mark = forth_POP(ctx);
+
+	if ((mark < heap->arena) || (mark > heap->limit))
+	{
+		forth_THROW(ctx, -9); // Invalid memory address.
+	}
+
+	heap->arena = mark;
+}
+
+const forth_vocabulary_entry_t forth_wl_memory[] =
+{
+DEF_FORTH_WORD( "allocate",  		0, forth_allocate,   		"( u -- a-addr ior )"),
+DEF_FORTH_WORD( "free",  	 		0, forth_free,     	 		"( a-addr -- ior )"),
+DEF_FORTH_WORD( "resize",  	 		0, forth_resize,   	 		"( a-addr1 u -- a-addr2 ior )"),
+DEF_FORTH_WORD( "arena-mark",  		0, forth_arena_mark,   		"( -- mark )"),
+DEF_FORTH_WORD( "arena-allocate", 	0, forth_arena_allocate,	"( u -- a-addr ior )"),
+DEF_FORTH_WORD( "arena-release",	0, forth_arena_release,		"( mark -- )"),
+DEF_FORTH_WORD(0, 0, 0, 0)
+};
+#endif
@@ -42,6 +42,7 @@ void forth_forth(forth_runtime_context_t *ctx)
 	}
 
 	ctx->wordlists[ctx->wordlist_slots - ctx->wordlist_cnt] = (forth_cell_t)&(ctx->dictionary->forth_wl);
+	FORTH_NAMES_CHANGED(ctx);
 }
 
 #if !defined(FORTH_WITHOUT_COMPILATION)
@@ -65,6 +66,7 @@ int forth_InitSearchOrder(forth_runtime_context_t *ctx, forth_cell_t *wordlists,
 	ctx->wordlists[slots - 1] = (forth_cell_t)&forth_root_wordlist;
 	ctx->wordlists[slots - 2] = (forth_cell_t)&(ctx->dictionary->forth_wl);
 	ctx->current =	(forth_cell_t)&(ctx->dictionary->forth_wl);
+	FORTH_NAMES_CHANGED(ctx);
 
 	return 0;
 }
@@ -181,6 +183,7 @@ void forth_also(forth_runtime_context_t *ctx)
 	cnt += 1;
 	ctx->wordlists[ctx->wordlist_slots - cnt] = ctx->wordlists[ctx->wordlist_slots - ctx->wordlist_cnt ];
 	ctx->wordlist_cnt = cnt;
+	FORTH_NAMES_CHANGED(ctx);
 }
 
 // PREVIOUS ( -- )
@@ -199,6 +202,7 @@ void forth_previous(forth_runtime_context_t *ctx)
 	}
 
 	ctx->wordlist_cnt = cnt - 1;
+	FORTH_NAMES_CHANGED(ctx);
 }
 
 // ONLY ( -- )
@@ -216,6 +220,7 @@ void forth_only(forth_runtime_context_t *ctx)
 
 	ctx->wordlist_cnt = 1;
 	ctx->wordlists[ctx->wordlist_slots - 1] = (forth_cell_t)&forth_root_wordlist;
+	FORTH_NAMES_CHANGED(ctx);
 }
 
 // SET-ORDER ( WIDn ... WID2 WID1 n -- )
@@ -246,6 +251,8 @@ void forth_set_order(forth_runtime_context_t *ctx)
 	{
 		ctx->wordlists[ctx->wordlist_slots - i] = forth_POP(ctx);
 	}
+
+	FORTH_NAMES_CHANGED(ctx);
 }
 
 // WORDLIST ( -- wid )
@@ -279,6 +286,7 @@ void forth_do_voc(forth_runtime_context_t *ctx)
     // the WID is the same as the addres of the CREATEd word.
     // forth_fetch(ctx);
     ctx->wordlists[ctx->wordlist_slots - ctx->wordlist_cnt] = forth_POP(ctx);
+	FORTH_NAMES_CHANGED(ctx);
 }
 
 // Define a vocabulary.
@@ -294,7 +302,7 @@ void forth_vocabulary(forth_runtime_context_t *ctx)
     entry = forth_GET_LATEST(ctx);
     forth_wordlist(ctx);
     wid = (forth_wordlist_t *)forth_POP(ctx);
-    wid->name = entry->name;
+    wid->name = (forth_cell_t)FORTH_ENTRY_NAME(entry);
     entry->meaning = (forth_cell_t)forth_DO_VOC_xt;
 }
 
@@ -392,14 +400,14 @@ forth_vocabulary_entry_t *forth_SEARCH_WORDLIST(forth_wordlist_t *wid, const cha
 
     while (0 != p)
 	{
-        if (0 != p->name)
+        if (0 != FORTH_ENTRY_NAME(p))
         {
-            if (forth_COMPARE_NAMES((char *)(p->name), name, name_length))
+            if (forth_COMPARE_NAMES(FORTH_ENTRY_NAME(p), name, name_length))
             {
                 return p;
             }  
         }
-        p = (forth_vocabulary_entry_t *)(p->link); 
+        p = FORTH_ENTRY_LINK(p); 
     }
     return 0;
 }
@@ -598,21 +606,21 @@ void forth_PRINT_LIST(forth_runtime_context_t *ctx, const forth_vocabulary_entry
 {
     size_t len;
 
-    while((0 != ep) && (0 != ep->name))
+    while((0 != ep) && (0 != FORTH_ENTRY_NAME(ep)))
     {
-      	len = strlen((char *)(ep->name));
+      	len = strlen(FORTH_ENTRY_NAME(ep));
 
-        if ((ctx->terminal_width - ctx->terminal_col) <= len)
+        if ((ctx->terminal_width - FORTH_TERMINAL_COL(ctx)) <= len)
 		{
             forth_cr(ctx);
         }
 
-        forth_TYPE0(ctx, (char *)(ep->name));
+        forth_TYPE0(ctx, FORTH_ENTRY_NAME(ep));
         forth_space(ctx);
 
         if (linked)
         {
-            ep = (const forth_vocabulary_entry_t *)(ep->link);
+            ep = FORTH_ENTRY_LINK(ep);
         }
         else
         {
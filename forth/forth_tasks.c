@@ -0,0 +1,282 @@
+/*
+* forth_tasks.c
+*
+*  Created on: Oct 18, 2026
+*      Author: Andras Zsoter
+*
+* Copyright (c) 2026 Andras Zsoter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+#include <forth.h>
+#include <forth_internal.h>
+#include <string.h>
+
+#if !defined(FORTH_WITHOUT_COMPILATION) && defined(FORTH_INCLUDE_TASKS)
+// Cooperative multitasking.
+// Tasks are contexts (with their own stacks) living in the dictionary, all of them share the dictionary of the context
+// that has created them. The scheduler runs the awake tasks in a round robin fashion, each of them until it executes PAUSE,
+// STOP or runs out of its time slice (which uses the instruction budget, see Forth_RunWithBudget()).
+// Since a task is suspended by leaving its state in its context there is no need for separate C stacks.
+
+// Return the task whose context is CTX if it is being run by the scheduler, 0 otherwise.
+static forth_task_t *forth_CURRENT_TASK(forth_runtime_context_t *ctx)
+{
+	forth_task_t *task = (forth_task_t *)(ctx->dictionary->current_task);
+
+	return ((0 != task) && (ctx == &(task->ctx))) ? task : 0;
+}
+
+// Run TASK until it pauses, stops or MAX_STEPS have been executed (0 means no limit).
+static void forth_RUN_TASK(forth_task_t *task, forth_cell_t max_steps)
+{
+	forth_runtime_context_t *ctx = &(task->ctx);
+	jmp_buf exit_frame;
+
+	if (0 == setjmp(exit_frame))
+	{
+		ctx->bye_handler = (forth_cell_t)(&exit_frame);
+		ctx->quit_handler = (forth_cell_t)(&exit_frame);
+		(void)forth_RUN_RESUMABLE(ctx, max_steps);
+	}
+	else
+	{
+		// BYE or QUIT end the task.
+		ctx->ip = 0;
+	}
+
+	ctx->bye_handler = 0;
+	ctx->quit_handler = 0;
+	ctx->throw_handler = 0;
+	ctx->suspend_handler = 0;
+	(void)forth_FLUSH_OUTPUT(ctx);	// The task shares the output device with the others.
+
+	if (0 == ctx->ip)
+	{
+		// The task has finished (or it has been terminated by an exception).
+		task->status = FORTH_TASK_ASLEEP;
+	}
+}
+
+// Run all awake tasks of DICTIONARY once, return the number of tasks still awake.
+static forth_scell_t forth_RUN_TASKS(forth_dictionary_t *dictionary, forth_cell_t max_steps)
+{
+	forth_task_t *task;
+	forth_scell_t awake = 0;
+
+	for (task = (forth_task_t *)(dictionary->tasks); 0 != task; task = (forth_task_t *)(task->link))
+	{
+		if (FORTH_TASK_AWAKE == task->status)
+		{
+			dictionary->current_task = (forth_cell_t)task;
+			forth_RUN_TASK(task, max_steps);
+			dictionary->current_task = 0;
+
+			if (FORTH_TASK_AWAKE == task->status)
+			{
+				awake++;
+			}
+		}
+	}
+
+	return awake;
+}
+
+// Run the scheduler for one round: each awake task in the dictionary of CTX runs until it executes PAUSE or STOP,
+// or until it has executed MAX_STEPS steps (0 means no limit).
+// Return the number of tasks that are still awake (so the application knows whether it is worth to call again).
+forth_scell_t Forth_RunTasks(forth_runtime_context_t *ctx, forth_cell_t max_steps)
+{
+	if ((0 == ctx) || (0 == ctx->dictionary))
+	{
+		return -9; // Invalid memory address, is there anything better here?
+	}
+
+	if (0 != ctx->dictionary->current_task)
+	{
+		return -21; // Unsupported operation -- the scheduler is already running.
+	}
+
+	return forth_RUN_TASKS(ctx->dictionary, max_steps);
+}
+
+// TASK ( "<name>" -- )
+// Create a task, name ( -- task ).
+void forth_task(forth_runtime_context_t *ctx)
+{
+	forth_vocabulary_entry_t *entry;
+	forth_task_t *task;
+	forth_context_init_data_t init_data;
+
+	entry = forth_PARSE_NAME_AND_CREATE_ENTRY(ctx);
+	FORTH_SET_XT_FLAGS(entry, FORTH_XT_FLAGS_ACTION_CONSTANT);
+	forth_here(ctx);
+	task = (forth_task_t *)(forth_POP(ctx) + sizeof(forth_cell_t));
+	forth_COMMA(ctx, (forth_cell_t)task); // Meaning.
+	forth_PUSH(ctx, sizeof(forth_task_t));
+	forth_allot(ctx);
+
+	init_data.dictionary = ctx->dictionary;
+	init_data.data_stack = task->data_stack;
+	init_data.return_stack = task->return_stack;
+	init_data.data_stack_cell_count = FORTH_TASK_DATA_STACK_CELLS;
+	init_data.return_stack_cell_count = FORTH_TASK_RETURN_STACK_CELLS;
+	init_data.search_order = task->search_order;
+	init_data.search_order_slots = FORTH_TASK_SEARCH_ORDER_SLOTS;
+	init_data.cold = (forth_cold_context_t *)(task->cold);
+	(void)Forth_InitContext(&(task->ctx), &init_data);
+	task->ctx.cold->input_buffers = 0;	// Its cold block is cut short (see FORTH_TASK_COLD_CELLS).
+
+	forth_INHERIT_DEVICES(&(task->ctx), ctx);	// The task talks to the same devices as its creator.
+	task->ctx.source_address = 0;
+	task->ctx.source_id = -1;
+
+	task->status = FORTH_TASK_ASLEEP;
+	task->link = ctx->dictionary->tasks;
+	ctx->dictionary->tasks = (forth_cell_t)task;
+
+	forth_SET_LINK(ctx, entry, forth_GET_LATEST(ctx));
+	forth_SET_LATEST(ctx, entry);
+}
+
+// ACTIVATE ( task -- )
+// The rest of the definition containing ACTIVATE becomes the code of TASK, which is started (with empty stacks).
+void forth_activate(forth_runtime_context_t *ctx)
+{
+	forth_task_t *task = (forth_task_t *)forth_POP(ctx);
+	forth_runtime_context_t *tctx = &(task->ctx);
+
+	if (0 == ctx->ip)
+	{
+		forth_THROW(ctx, -14); // Interpreting a compile-only word.
+	}
+
+#if defined(FORTH_INCLUDE_LOCALS)
+	if (0 != ctx->fp)
+	{
+		forth_THROW(ctx, -21); // Unsupported operation -- the task could not see the local variables.
+	}
+#endif
+
+	if (tctx == ctx)
+	{
+		forth_THROW(ctx, -21); // Unsupported operation -- a task cannot restart itself.
+	}
+
+	tctx->sp = tctx->sp0;
+	tctx->rp = tctx->rp0;
+	forth_RPUSH(tctx, 0);	// The task ends when its code returns.
+	tctx->ip = ctx->ip;
+	tctx->state = 0;
+	tctx->to_in = 0;
+	tctx->source_length = 0;
+	task->status = FORTH_TASK_AWAKE;
+
+	forth_exit(ctx);
+}
+
+// PAUSE ( -- )
+// Let the other tasks (and the scheduler of the application, see the pause hook in the context) run.
+void forth_pause(forth_runtime_context_t *ctx)
+{
+	forth_task_t *task;
+
+	if (0 == ctx->dictionary)
+	{
+		forth_THROW(ctx, -21); // Unsupported operation.
+	}
+
+	task = forth_CURRENT_TASK(ctx);
+
+	if (0 > forth_FLUSH_OUTPUT(ctx))	// Before the others get a chance to write.
+	{
+		forth_THROW(ctx, -57);
+	}
+
+	// The task can only be suspended if there is no C code between its threaded code and the scheduler,
+	// otherwise (e.g. inside CATCH) it only lets the application's scheduler run.
+	if ((0 != task) && (0 != ctx->suspend_handler) && (1 == ctx->nesting))
+	{
+		longjmp(*(jmp_buf *)(ctx->suspend_handler), FORTH_EXIT_PAUSE);
+	}
+
+	if (0 != ctx->pause)
+	{
+		(void)ctx->pause(ctx);
+	}
+
+#if defined(FORTH_INCLUDE_THREADS)
+	if (0 != ctx->dictionary_frozen)
+	{
+		return;	// Worker threads must not run the tasks of their creator.
+	}
+#endif
+
+	if ((0 == task) && (0 == ctx->dictionary->current_task))
+	{
+		// Not a task, give all tasks a turn.
+		(void)forth_RUN_TASKS(ctx->dictionary, 0);
+	}
+}
+
+// STOP ( -- )
+// Put the current task to sleep until it is woken up by WAKE.
+void forth_stop(forth_runtime_context_t *ctx)
+{
+	forth_task_t *task;
+
+	if (0 == ctx->dictionary)
+	{
+		forth_THROW(ctx, -21); // Unsupported operation.
+	}
+
+	task = forth_CURRENT_TASK(ctx);
+
+	if (0 == task)
+	{
+		forth_THROW(ctx, -21); // Unsupported operation -- not a task.
+	}
+
+	task->status = FORTH_TASK_ASLEEP;
+	forth_pause(ctx);
+}
+
+// WAKE ( task -- )
+void forth_wake(forth_runtime_context_t *ctx)
+{
+	forth_task_t *task = (forth_task_t *)forth_POP(ctx);
+
+	if (0 != task->ctx.ip)
+	{
+		task->status = FORTH_TASK_AWAKE;
+	}
+}
+
+const forth_vocabulary_entry_t forth_wl_tasks[] =
+{
+DEF_FORTH_WORD( "task",  	 0, forth_task,      	    "( \"<name>\" -- )"),
+DEF_FORTH_WORD( "activate",  0, forth_activate,    	    "( task -- )"),
+DEF_FORTH_WORD( "pause",  	 0, forth_pause,      	    "( -- )"),
+DEF_FORTH_WORD( "stop",  	 0, forth_stop,      	    "( -- )"),
+DEF_FORTH_WORD( "wake",  	 0, forth_wake,      	    "( task -- )"),
+DEF_FORTH_WORD(0, 0, 0, 0)
+};
+#endif
@@ -0,0 +1,766 @@
+/*
+* forth_threads.c
+*
+*  Created on: Oct 18, 2026
+*      Author: Andras Zsoter
+*
+* Copyright (c) 2026 Andras Zsoter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+#include <forth.h>
+#include <forth_internal.h>
+#include <string.h>
+
+#if !defined(FORTH_WITHOUT_COMPILATION) && defined(FORTH_INCLUDE_THREADS)
+#include <pthread.h>
+
+// A pool of worker threads running jobs (xt-s with their arguments) started by SPAWN.
+// Each worker has its own context bound to the dictionary of the context that has started the pool, the dictionary
+// is frozen for the workers (they cannot ALLOT, compile, etc.) so it can be read without locking.
+// Each worker has a deque of jobs, it takes jobs from the bottom of its own deque (newest first) and when that is empty
+// it steals from the top (oldest first) of the others.
+// A thread waiting in JOIN runs other jobs in the meantime, so nested SPAWN/JOIN pairs cannot starve the pool.
+
+#define FORTH_JOB_FREE		0
+#define FORTH_JOB_QUEUED	1
+#define FORTH_JOB_RUNNING	2
+#define FORTH_JOB_DONE		3
+
+struct forth_job
+{
+	struct forth_job	*next;							// Free list.
+	forth_cell_t		status;							// FORTH_JOB_...
+	forth_xt_t			xt;								// What to execute.
+	forth_scell_t		result;							// The THROW code.
+	forth_cell_t		count;							// The number of arguments, and then of the results.
+	forth_cell_t		cells[FORTH_JOB_MAX_CELLS];		// The arguments, and then the results.
+};
+typedef struct forth_job forth_job_t;
+
+struct forth_deque
+{
+	pthread_mutex_t		lock;
+	forth_cell_t		top;							// Jobs are stolen from here.
+	forth_cell_t		bottom;							// The owner pushes and pops jobs here.
+	forth_job_t			*jobs[FORTH_MAX_JOBS];			// There are no more jobs than this, so it cannot overflow.
+};
+typedef struct forth_deque forth_deque_t;
+
+struct forth_worker
+{
+	forth_runtime_context_t		ctx;
+	struct forth_worker_pool	*pool;
+	pthread_t					thread;
+	forth_deque_t				deque;
+	forth_cell_t				data_stack[FORTH_WORKER_DATA_STACK_CELLS];
+	forth_cell_t				return_stack[FORTH_WORKER_RETURN_STACK_CELLS];
+	forth_cell_t				search_order[FORTH_WORKER_SEARCH_ORDER_SLOTS];
+	forth_cold_context_t		cold;
+};
+typedef struct forth_worker forth_worker_t;
+
+struct forth_worker_pool
+{
+	pthread_mutex_t		lock;							// Protects everything in the pool except the deques.
+	pthread_cond_t		changed;						// A job has been queued or finished.
+	forth_cell_t		worker_count;
+	forth_cell_t		next_worker;					// Where jobs spawned outside the workers go.
+	forth_cell_t		queued;							// The number of jobs in the deques.
+	forth_cell_t		stopping;
+	forth_job_t			*free_jobs;
+	forth_job_t			jobs[FORTH_MAX_JOBS];
+	forth_worker_t		workers[1];						// Place holder for WORKER_COUNT workers.
+};
+typedef struct forth_worker_pool forth_worker_pool_t;
+
+// Return the worker whose context is CTX, 0 if CTX does not belong to a worker of POOL.
+static forth_worker_t *forth_WORKER_OF(forth_worker_pool_t *pool, forth_runtime_context_t *ctx)
+{
+	forth_worker_t *worker = (forth_worker_t *)ctx;
+
+	if ((worker < pool->workers) || (worker >= (pool->workers + pool->worker_count)))
+	{
+		return 0;
+	}
+
+	return worker;
+}
+
+static void forth_PUSH_JOB(forth_worker_pool_t *pool, forth_deque_t *deque, forth_job_t *job)
+{
+	pthread_mutex_lock(&(deque->lock));
+	deque->jobs[deque->bottom % FORTH_MAX_JOBS] = job;
+	deque->bottom++;
+	pthread_mutex_unlock(&(deque->lock));
+
+	pthread_mutex_lock(&(pool->lock));
+	pool->queued++;
+	pthread_cond_broadcast(&(pool->changed));
+	pthread_mutex_unlock(&(pool->lock));
+}
+
+// Take a job from DEQUE, from the bottom if the caller owns it (OWN), otherwise from the top.
+static forth_job_t *forth_TAKE_JOB(forth_worker_pool_t *pool, forth_deque_t *deque, int own)
+{
+	forth_job_t *job = 0;
+
+	pthread_mutex_lock(&(deque->lock));
+
+	if (deque->top != deque->bottom)
+	{
+		if (own)
+		{
+			deque->bottom--;
+			job = deque->jobs[deque->bottom % FORTH_MAX_JOBS];
+		}
+		else
+		{
+			job = deque->jobs[deque->top % FORTH_MAX_JOBS];
+			deque->top++;
+		}
+	}
+
+	pthread_mutex_unlock(&(deque->lock));
+
+	if (0 != job)
+	{
+		pthread_mutex_lock(&(pool->lock));
+		pool->queued--;
+		job->status = FORTH_JOB_RUNNING;
+		pthread_mutex_unlock(&(pool->lock));
+	}
+
+	return job;
+}
+
+// Find a job for WORKER (0 if the caller is not a worker): its own deque first, then steal from the others.
+static forth_job_t *forth_FIND_JOB(forth_worker_pool_t *pool, forth_worker_t *worker)
+{
+	forth_job_t *job;
+	forth_cell_t first = (0 != worker) ? (forth_cell_t)(worker - pool->workers) : 0;
+	forth_cell_t i;
+
+	if (0 != worker)
+	{
+		job = forth_TAKE_JOB(pool, &(worker->deque), 1);
+
+		if (0 != job)
+		{
+			return job;
+		}
+	}
+
+	for (i = 1; i <= pool->worker_count; i++)
+	{
+		job = forth_TAKE_JOB(pool, &(pool->workers[(first + i) % pool->worker_count].deque), 0);
+
+		if (0 != job)
+		{
+			return job;
+		}
+	}
+
+	return 0;
+}
+
+// Execute JOB on top of whatever is on the stacks of CTX, collect the results in JOB and return the THROW code.
+static forth_scell_t forth_EXECUTE_JOB(forth_runtime_context_t *ctx, forth_job_t *job)
+{
+	forth_cell_t *saved_sp = ctx->sp;
+	forth_cell_t *saved_rp = ctx->rp;
+	forth_token_t *saved_ip = ctx->ip;
+#if defined(FORTH_INCLUDE_LOCALS)
+	forth_cell_t *saved_fp = ctx->fp;
+#endif
+	forth_cell_t saved_throw_handler = ctx->throw_handler;
+	forth_cell_t saved_quit_handler = ctx->quit_handler;
+	forth_cell_t saved_nesting = ctx->nesting;
+	forth_scell_t res;
+	forth_cell_t i;
+	jmp_buf quit_frame;
+
+	if (0 == setjmp(quit_frame))
+	{
+		ctx->quit_handler = (forth_cell_t)(&quit_frame);
+
+		for (i = 0; i < job->count; i++)
+		{
+			*--(ctx->sp) = job->cells[i];
+		}
+
+		res = forth_CATCH(ctx, job->xt);
+	}
+	else
+	{
+		res = -56; // QUIT
+	}
+
+	if ((0 == res) && (ctx->sp > saved_sp))
+	{
+		res = -4; // Stack underflow -- the xt has consumed more than its arguments.
+	}
+
+	if (0 == res)
+	{
+		job->count = saved_sp - ctx->sp;
+
+		if (job->count > FORTH_JOB_MAX_CELLS)
+		{
+			job->count = 0;
+			res = -3; // Stack overflow -- too many results.
+		}
+
+		for (i = 0; i < job->count; i++)
+		{
+			job->cells[i] = saved_sp[-(forth_scell_t)(i + 1)];
+		}
+	}
+	else
+	{
+		job->count = 0;
+	}
+
+	ctx->sp = saved_sp;
+	ctx->rp = saved_rp;
+	ctx->ip = saved_ip;
+#if defined(FORTH_INCLUDE_LOCALS)
+	ctx->fp = saved_fp;
+#endif
+	ctx->throw_handler = saved_throw_handler;
+	ctx->quit_handler = saved_quit_handler;
+	ctx->nesting = saved_nesting;
+
+	return res;
+}
+
+// Run JOB on CTX and let its owner know it is done.
+static void forth_RUN_JOB(forth_worker_pool_t *pool, forth_runtime_context_t *ctx, forth_job_t *job)
+{
+	forth_scell_t res = forth_EXECUTE_JOB(ctx, job);
+
+	(void)forth_FLUSH_OUTPUT(ctx);	// Before the owner of the job can see that it is done.
+	pthread_mutex_lock(&(pool->lock));
+	job->result = res;
+	job->status = FORTH_JOB_DONE;
+	pthread_cond_broadcast(&(pool->changed));
+	pthread_mutex_unlock(&(pool->lock));
+}
+
+static void *forth_WORKER_MAIN(void *arg)
+{
+	forth_worker_t *worker = (forth_worker_t *)arg;
+	forth_worker_pool_t *pool = worker->pool;
+	forth_job_t *job;
+	forth_cell_t stopping;
+
+	while (1)
+	{
+		job = forth_FIND_JOB(pool, worker);
+
+		if (0 != job)
+		{
+			forth_RUN_JOB(pool, &(worker->ctx), job);
+			continue;
+		}
+
+		pthread_mutex_lock(&(pool->lock));
+
+		while ((0 == pool->queued) && (0 == pool->stopping))
+		{
+			pthread_cond_wait(&(pool->changed), &(pool->lock));
+		}
+
+		stopping = (0 == pool->queued) && (0 != pool->stopping);
+		pthread_mutex_unlock(&(pool->lock));
+
+		if (stopping)
+		{
+			break;
+		}
+	}
+
+	return 0;
+}
+
+// The size of the memory needed by Forth_StartWorkers() for WORKER_COUNT workers.
+forth_cell_t Forth_GetWorkerPoolSize(unsigned int worker_count)
+{
+	return sizeof(forth_worker_pool_t) + ((worker_count - 1) * sizeof(forth_worker_t));
+}
+
+// Start WORKER_COUNT worker threads for SPAWN, using the dictionary and the devices of CTX.
+// MEMORY must be at least Forth_GetWorkerPoolSize() bytes (suitably aligned for the pthread types) and it must stay
+// valid until Forth_StopWorkers() is called.
+forth_scell_t Forth_StartWorkers(forth_runtime_context_t *ctx, void *memory, unsigned int worker_count)
+{
+	forth_worker_pool_t *pool = (forth_worker_pool_t *)memory;
+	forth_worker_t *worker;
+	forth_context_init_data_t init_data;
+	forth_cell_t i;
+
+	if ((0 == ctx) || (0 == ctx->dictionary) || (0 == memory))
+	{
+		return -9; // Invalid memory address, is there anything better here?
+	}
+
+	if ((0 == worker_count) || (0 != ctx->dictionary->workers))
+	{
+		return -21; // Unsupported operation.
+	}
+
+	memset(pool, 0, Forth_GetWorkerPoolSize(worker_count));
+	pthread_mutex_init(&(pool->lock), 0);
+	pthread_cond_init(&(pool->changed), 0);
+	pool->worker_count = worker_count;
+
+	for (i = 0; i < FORTH_MAX_JOBS; i++)
+	{
+		pool->jobs[i].next = pool->free_jobs;
+		pool->free_jobs = &(pool->jobs[i]);
+	}
+
+	for (i = 0; i < worker_count; i++)
+	{
+		worker = &(pool->workers[i]);
+		worker->pool = pool;
+		pthread_mutex_init(&(worker->deque.lock), 0);
+
+		init_data.dictionary = ctx->dictionary;
+		init_data.data_stack = worker->data_stack;
+		init_data.return_stack = worker->return_stack;
+		init_data.data_stack_cell_count = FORTH_WORKER_DATA_STACK_CELLS;
+		init_data.return_stack_cell_count = FORTH_WORKER_RETURN_STACK_CELLS;
+		init_data.search_order = worker->search_order;
+		init_data.search_order_slots = FORTH_WORKER_SEARCH_ORDER_SLOTS;
+		init_data.cold = &(worker->cold);
+		(void)Forth_InitContext(&(worker->ctx), &init_data);
+		forth_INHERIT_DEVICES(&(worker->ctx), ctx);
+		worker->ctx.dictionary_frozen = 1;
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION)
+		worker->ctx.heap = 0;	// The heap is not thread safe.
+#endif
+	}
+
+	ctx->dictionary->workers = (forth_cell_t)pool;
+
+	for (i = 0; i < worker_count; i++)
+	{
+		worker = &(pool->workers[i]);
+
+		if (0 != pthread_create(&(worker->thread), 0, forth_WORKER_MAIN, worker))
+		{
+			pool->worker_count = i;
+			Forth_StopWorkers(ctx);
+			return -21; // Unsupported operation.
+		}
+	}
+
+	return 0;
+}
+
+// Wait for the jobs already spawned and stop the workers.
+void Forth_StopWorkers(forth_runtime_context_t *ctx)
+{
+	forth_worker_pool_t *pool;
+	forth_cell_t i;
+
+	if ((0 == ctx) || (0 == ctx->dictionary) || (0 == ctx->dictionary->workers))
+	{
+		return;
+	}
+
+	pool = (forth_worker_pool_t *)(ctx->dictionary->workers);
+
+	pthread_mutex_lock(&(pool->lock));
+	pool->stopping = 1;
+	pthread_cond_broadcast(&(pool->changed));
+	pthread_mutex_unlock(&(pool->lock));
+
+	for (i = 0; i < pool->worker_count; i++)
+	{
+		pthread_join(pool->workers[i].thread, 0);
+		pthread_mutex_destroy(&(pool->workers[i].deque.lock));
+	}
+
+	pthread_cond_destroy(&(pool->changed));
+	pthread_mutex_destroy(&(pool->lock));
+	ctx->dictionary->workers = 0;
+}
+
+static forth_worker_pool_t *forth_POOL(forth_runtime_context_t *ctx)
+{
+	if ((0 == ctx->dictionary) || (0 == ctx->dictionary->workers))
+	{
+		forth_THROW(ctx, -21); // Unsupported operation -- no workers have been started.
+	}
+
+	return (forth_worker_pool_t *)(ctx->dictionary->workers);
+}
+
+// Queue a job running XT with the N arguments in CELLS, return 0 if there are no free job slots.
+static forth_job_t *forth_QUEUE_JOB(forth_worker_pool_t *pool, forth_runtime_context_t *ctx, forth_xt_t xt, const forth_cell_t *cells, forth_cell_t n)
+{
+	forth_worker_t *worker;
+	forth_job_t *job;
+
+	pthread_mutex_lock(&(pool->lock));
+	job = pool->free_jobs;
+
+	if (0 != job)
+	{
+		pool->free_jobs = job->next;
+		job->status = FORTH_JOB_QUEUED;
+	}
+
+	pthread_mutex_unlock(&(pool->lock));
+
+	if (0 == job)
+	{
+		return 0;
+	}
+
+	job->xt = xt;
+	job->result = 0;
+	job->count = n;
+	memcpy(job->cells, cells, n * sizeof(forth_cell_t));
+
+	worker = forth_WORKER_OF(pool, ctx);
+
+	if (0 == worker)
+	{
+		pthread_mutex_lock(&(pool->lock));
+		worker = &(pool->workers[pool->next_worker]);
+		pool->next_worker = (pool->next_worker + 1) % pool->worker_count;
+		pthread_mutex_unlock(&(pool->lock));
+	}
+
+	forth_PUSH_JOB(pool, &(worker->deque), job);
+
+	return job;
+}
+
+// Wait until JOB is done, running other jobs on CTX in the meantime.
+// Copy its results to RESULTS (FORTH_JOB_MAX_CELLS), store their number in COUNT, free JOB and return its THROW code.
+static forth_scell_t forth_WAIT_FOR_JOB(forth_worker_pool_t *pool, forth_runtime_context_t *ctx, forth_job_t *job, forth_cell_t *results, forth_cell_t *count)
+{
+	forth_worker_t *worker = forth_WORKER_OF(pool, ctx);
+	forth_job_t *other;
+	forth_scell_t res;
+	int can_help;
+
+	while (1)
+	{
+		pthread_mutex_lock(&(pool->lock));
+
+		if (FORTH_JOB_DONE == job->status)
+		{
+			pthread_mutex_unlock(&(pool->lock));
+			break;
+		}
+
+		pthread_mutex_unlock(&(pool->lock));
+
+		// Help instead of just waiting, if there is enough room for a job on the stack.
+		other = 0;
+		can_help = ((ctx->sp - ctx->sp_min) > (2 * FORTH_JOB_MAX_CELLS)) && ((ctx->rp - ctx->rp_min) > 32);
+
+		if (can_help)
+		{
+			other = forth_FIND_JOB(pool, worker);
+		}
+
+		if (0 != other)
+		{
+			forth_RUN_JOB(pool, ctx, other);
+			continue;
+		}
+
+		pthread_mutex_lock(&(pool->lock));
+
+		// Without room for another job, queued jobs are no reason to wake up: wait for this one only.
+		while ((FORTH_JOB_DONE != job->status) && (!can_help || (0 == pool->queued)))
+		{
+			pthread_cond_wait(&(pool->changed), &(pool->lock));
+		}
+
+		pthread_mutex_unlock(&(pool->lock));
+	}
+
+	res = job->result;
+	*count = job->count;
+	memcpy(results, job->cells, job->count * sizeof(forth_cell_t));
+
+	pthread_mutex_lock(&(pool->lock));
+	job->status = FORTH_JOB_FREE;
+	job->next = pool->free_jobs;
+	pool->free_jobs = job;
+	pthread_mutex_unlock(&(pool->lock));
+
+	return res;
+}
+
+// SPAWN ( x1 ... xn n xt -- job )
+// Run XT with the arguments x1 ... xn on a worker thread, JOIN returns its results.
+void forth_spawn(forth_runtime_context_t *ctx)
+{
+	forth_worker_pool_t *pool = forth_POOL(ctx);
+	forth_xt_t xt = (forth_xt_t)forth_POP(ctx);
+	forth_cell_t n = forth_POP(ctx);
+	forth_cell_t cells[FORTH_JOB_MAX_CELLS];
+	forth_job_t *job;
+	forth_cell_t i;
+
+	if (n > FORTH_JOB_MAX_CELLS)
+	{
+		forth_THROW(ctx, -24); // Invalid numeric argument.
+	}
+
+	forth_CHECK_STACK_AT_LEAST(ctx, n);
+
+	for (i = 0; i < n; i++)
+	{
+		cells[i] = ctx->sp[n - 1 - i];	// The job pushes its arguments starting with cells[0], that is x1.
+	}
+
+	job = forth_QUEUE_JOB(pool, ctx, xt, cells, n);
+
+	if (0 == job)
+	{
+		forth_THROW(ctx, FORTH_THROW_TOO_MANY_JOBS);
+	}
+
+	ctx->sp += n;
+	forth_PUSH(ctx, (forth_cell_t)job);
+}
+
+// JOIN ( job -- y1 ... ym )
+// Wait for JOB and return the results of its xt, or rethrow the exception it has thrown.
+void forth_join(forth_runtime_context_t *ctx)
+{
+	forth_worker_pool_t *pool = forth_POOL(ctx);
+	forth_job_t *job = (forth_job_t *)forth_POP(ctx);
+	forth_scell_t res;
+	forth_cell_t count;
+	forth_cell_t results[FORTH_JOB_MAX_CELLS];
+	forth_cell_t i;
+
+	if ((job < pool->jobs) || (job >= (pool->jobs + FORTH_MAX_JOBS)))
+	{
+		forth_THROW(ctx, -9); // Invalid memory address -- not a job.
+	}
+
+	pthread_mutex_lock(&(pool->lock));
+	res = (FORTH_JOB_FREE == job->status) ? -9 : 0;
+	pthread_mutex_unlock(&(pool->lock));
+
+	if (0 != res)
+	{
+		forth_THROW(ctx, res); // Invalid memory address -- the job has already been joined.
+	}
+
+	res = forth_WAIT_FOR_JOB(pool, ctx, job, results, &count);
+
+	if (0 != res)
+	{
+		forth_THROW(ctx, res);
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		forth_PUSH(ctx, results[i]);
+	}
+}
+
+// The first index of chunk I of the range START ... LIMIT split into N chunks.
+static forth_scell_t forth_CHUNK_START(forth_scell_t start, forth_scell_t limit, forth_cell_t i, forth_cell_t n)
+{
+	return start + (forth_scell_t)(((forth_sdcell_t)(limit - start) * (forth_sdcell_t)i) / (forth_sdcell_t)n);
+}
+
+// (par-do) ( identity limit start reduce-xt -- result )
+// Followed by the offset of the code after PAR-LOOP and the loop itself compiled as a headerless xt ( acc limit start -- acc' ).
+// The range is split into chunks, one for each worker and one for the caller, each chunk starts with IDENTITY
+// and the results of the chunks are combined by REDUCE-XT ( acc1 acc2 -- acc ) in the order of the chunks.
+void forth_par_do_rt(forth_runtime_context_t *ctx)
+{
+	forth_xt_t reduce = (forth_xt_t)forth_POP(ctx);
+	forth_scell_t start = (forth_scell_t)forth_POP(ctx);
+	forth_scell_t limit = (forth_scell_t)forth_POP(ctx);
+	forth_cell_t identity = forth_POP(ctx);
+	forth_worker_pool_t *pool = (forth_worker_pool_t *)(ctx->dictionary->workers);
+	forth_job_t *jobs[FORTH_PAR_MAX_CHUNKS];
+	forth_cell_t values[FORTH_PAR_MAX_CHUNKS];
+	forth_job_t local_job;
+	forth_cell_t chunks;
+	forth_cell_t i;
+	forth_scell_t res;
+	forth_scell_t error = 0;
+	forth_xt_t body;
+
+	body = FORTH_HEADER_XT(FORTH_ALIGN(ctx->ip + 1));
+	ctx->ip += (forth_stoken_t)(ctx->ip[0]);
+
+	if (limit <= start)
+	{
+		forth_PUSH(ctx, identity);
+		return;
+	}
+
+	chunks = (0 == pool) ? 1 : (pool->worker_count + 1);
+	chunks = (chunks > FORTH_PAR_MAX_CHUNKS) ? FORTH_PAR_MAX_CHUNKS : chunks;
+	chunks = (chunks > (forth_cell_t)(limit - start)) ? (forth_cell_t)(limit - start) : chunks;
+
+	// The first chunk belongs to the caller, the others are queued as jobs if there are free job slots.
+	jobs[0] = 0;
+	values[0] = identity;	// Always overwritten by the first chunk, but the compiler cannot see that chunks >= 1.
+
+	for (i = 1; i < chunks; i++)
+	{
+		local_job.cells[0] = identity;
+		local_job.cells[1] = (forth_cell_t)forth_CHUNK_START(start, limit, i + 1, chunks);
+		local_job.cells[2] = (forth_cell_t)forth_CHUNK_START(start, limit, i, chunks);
+		jobs[i] = forth_QUEUE_JOB(pool, ctx, body, local_job.cells, 3);
+	}
+
+	// Run the chunks that have not been queued, then collect the rest.
+	// All jobs must be joined before an exception can be rethrown.
+	for (i = 0; i < chunks; i++)
+	{
+		if (0 != jobs[i])
+		{
+			continue;
+		}
+
+		local_job.xt = body;
+		local_job.count = 3;
+		local_job.cells[0] = identity;
+		local_job.cells[1] = (forth_cell_t)forth_CHUNK_START(start, limit, i + 1, chunks);
+		local_job.cells[2] = (forth_cell_t)forth_CHUNK_START(start, limit, i, chunks);
+		res = (0 == error) ? forth_EXECUTE_JOB(ctx, &local_job) : error;
+		error = ((0 == error) && (0 == res) && (1 != local_job.count)) ? -22 : ((0 == error) ? res : error);
+		values[i] = local_job.cells[0];
+	}
+
+	for (i = 0; i < chunks; i++)
+	{
+		if (0 == jobs[i])
+		{
+			continue;
+		}
+
+		res = forth_WAIT_FOR_JOB(pool, ctx, jobs[i], local_job.cells, &(local_job.count));
+		error = ((0 == error) && (0 == res) && (1 != local_job.count)) ? -22 : ((0 == error) ? res : error);
+		values[i] = local_job.cells[0];
+	}
+
+	if (0 != error)
+	{
+		forth_THROW(ctx, error);	// -22 Control structure mismatch -- the loop body must leave exactly one accumulator.
+	}
+
+	forth_PUSH(ctx, values[0]);
+
+	for (i = 1; i < chunks; i++)
+	{
+		forth_PUSH(ctx, values[i]);
+		res = forth_CATCH(ctx, reduce);
+
+		if (0 != res)
+		{
+			forth_THROW(ctx, res);
+		}
+	}
+}
+
+// PAR-DO ( C: -- par-sys ) ( identity limit start reduce-xt -- )
+// Like ?DO, but the iterations are split among the workers, each part starting with the accumulator IDENTITY.
+// The loop body is ( acc -- acc' ), I works as usual, J, locals and values left on the return stack by the code around
+// the loop are not available. When there are no workers the whole loop runs in the caller.
+void forth_par_do(forth_runtime_context_t *ctx)
+{
+	forth_token_t *skip_address;
+
+	if (0 == ctx->state)
+	{
+		forth_THROW(ctx, -14); // Interpreting a compile-only word.
+	}
+
+#if defined(FORTH_INCLUDE_LOCALS)
+	if (0 != ctx->dictionary->local_count)
+	{
+		forth_THROW(ctx, -21); // Unsupported operation -- the loop body could not see the local variables.
+	}
+#endif
+
+#if defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+	forth_ROOM(ctx, (5 * sizeof(forth_cell_t)) + FORTH_SEGMENT_COMPILE_ROOM); // Keep the loop header and (?DO) together.
+#endif
+	forth_COMPILE_COMMA(ctx, forth_pPAR_DO_xt); // (par-do)
+	forth_here(ctx);
+	skip_address = (forth_token_t *)forth_POP(ctx);
+	forth_TOKEN_COMMA(ctx, 0);	// Place holder for the offset.
+
+	(void)forth_NAMELESS_HEADER(ctx);	// The xt of the loop.
+
+	forth_PUSH(ctx, (forth_cell_t)skip_address);
+	forth_PUSH(ctx, FORTH_PAR_MARKER);
+	forth_q_do(ctx);
+}
+
+// PAR-LOOP ( C: par-sys -- ) ( acc -- )
+void forth_par_loop(forth_runtime_context_t *ctx)
+{
+	forth_token_t *skip_address;
+
+	forth_loop(ctx);
+	forth_COMPILE_COMMA(ctx, forth_pPAR_LOOP_xt);	// End of the loop xt.
+
+	if (FORTH_PAR_MARKER != forth_POP(ctx))
+	{
+		forth_THROW(ctx, -22); // Control structure mismatch.
+	}
+
+	skip_address = (forth_token_t *)forth_POP(ctx);
+	forth_here(ctx);
+	*skip_address = (forth_token_t)((forth_token_t *)forth_POP(ctx) - skip_address);
+}
+
+const forth_vocabulary_entry_t forth_wl_threads[] =
+{
+DEF_FORTH_WORD( "spawn",  	 0, forth_spawn,      	    "( x1 ... xn n xt -- job )"),
+DEF_FORTH_WORD( "join",  	 0, forth_join,      	    "( job -- y1 ... ym )"),
+DEF_FORTH_WORD( "par-do",  	 FORTH_XT_FLAGS_IMMEDIATE, forth_par_do,	"( identity limit start reduce-xt -- )"),
+DEF_FORTH_WORD( "par-loop",	 FORTH_XT_FLAGS_IMMEDIATE, forth_par_loop,	"( acc -- )"),
+DEF_FORTH_WORD(0, 0, 0, 0)
+};
+
+// Run time support of PAR-DO and PAR-LOOP, these are not in any word list.
+const forth_vocabulary_entry_t forth_wl_par_support[] =
+{
+DEF_FORTH_WORD( "(par-do)",  	 0, forth_par_do_rt,	"( identity limit start reduce-xt -- result )"),	// 0
+DEF_FORTH_WORD( "(par-loop)",  	 0, forth_exit,			"( -- )"),											// 1
+DEF_FORTH_WORD(0, 0, 0, 0)
+};
+
+const forth_xt_t forth_pPAR_DO_xt   = (const forth_xt_t)&(forth_wl_par_support[0]);
+const forth_xt_t forth_pPAR_LOOP_xt   = (const forth_xt_t)&(forth_wl_par_support[1]);
+#endif
@@ -0,0 +1,330 @@
+/*
+* api_tests.c
+*
+*  Created on: Oct 18, 2026
+*      Author: Andras Zsoter
+*
+* Copyright (c) 2026 Andras Zsoter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+// Tests of the C interface that cannot be written as Forth scripts (see quick-tests.txt for those).
+// Each test prints its title followed by OK or FAILED, run-tests appends the output to results.txt.
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <forth.h>
+#include <forth_internal.h>
+#include "app.h"
+#include "forth_guard_stacks.h"
+
+#define API_DICTIONARY_SIZE 4096 /* cells */
+#define API_STACK_CELLS 64
+#define API_SEARCH_ORDER_SIZE 16
+#define API_EVAL_CACHE_SIZE 4096 /* cells */
+#define API_HEAP_SIZE 4096 /* cells */
+
+#if !defined(FORTH_WITHOUT_COMPILATION)
+static forth_cell_t api_dictionary[API_DICTIONARY_SIZE];
+static forth_cell_t api_search_order[API_SEARCH_ORDER_SIZE];
+#endif
+#if defined(FORTH_GUARDED_STACKS)
+static forth_guarded_stacks_t api_guarded_stacks;	// The underflow test needs stacks that are really checked.
+#else
+static forth_cell_t api_data_stack[API_STACK_CELLS];
+static forth_cell_t api_return_stack[API_STACK_CELLS];
+#endif
+static forth_runtime_context_t api_ctx;
+static forth_cold_context_t api_ctx_cold;
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+static forth_cell_t api_eval_cache_memory[API_EVAL_CACHE_SIZE];
+#endif
+
+static int api_write_str(struct forth_runtime_context *rctx, const char *str, forth_cell_t length)
+{
+	fwrite(str, 1, length, stdout);
+	return 0;
+}
+
+static int api_send_cr(struct forth_runtime_context *rctx)
+{
+	putchar('\n');
+	return 0;
+}
+
+// An output device that has gone away (e.g. a closed network connection).
+static int api_failing_write_str(struct forth_runtime_context *rctx, const char *str, forth_cell_t length)
+{
+	return -1;
+}
+
+static int api_failing_send_cr(struct forth_runtime_context *rctx)
+{
+	return -1;
+}
+
+static void api_check(const char *title, int ok)
+{
+	printf("%s: %s\n", title, ok ? "OK" : "FAILED");
+}
+
+// Run CMD in CTX (on whatever is on the stack), return whether the result is EXPECTED_RES.
+static int api_run(forth_runtime_context_t *ctx, const char *cmd, forth_scell_t expected_res)
+{
+	return expected_res == Forth(ctx, cmd, strlen(cmd), 0);
+}
+
+// The output device fails: the script is aborted if it can see the failure, otherwise the application is told by -57.
+static void api_failing_device(void)
+{
+	const char *cmd = "s\" x\" type";
+	forth_scell_t res;
+
+	api_ctx.write_string = &api_failing_write_str;
+	api_ctx.send_cr = &api_failing_send_cr;
+
+	api_check("Failing output device, Forth()", api_run(&api_ctx, "s\" x\" type 1 .", -57));
+	res = Forth_RunWithBudget(&api_ctx, cmd, strlen(cmd), 0);
+	api_check("Failing output device, Forth_RunWithBudget()", -57 == res);
+	api_check("Failing output device, CR", api_run(&api_ctx, "1 . cr 2 .", -57));
+
+	api_ctx.write_string = &api_write_str;
+	api_ctx.send_cr = &api_send_cr;
+	api_check("Working output device again", api_run(&api_ctx, "", 0) && api_run(&api_ctx, "1 drop", 0));
+}
+
+// An exception under a budget must leave the context usable for the next script.
+static void api_budget_underflow(void)
+{
+	const char *cmd = ". . .";
+	forth_scell_t res;
+
+	res = Forth_RunWithBudget(&api_ctx, cmd, strlen(cmd), 1000);
+	printf("\n");
+	api_check("Stack underflow under a budget", -4 == res);
+	api_check("Running a script after the underflow", api_run(&api_ctx, "1 2 + drop", 0));
+	cmd = "1 drop";
+	res = Forth_RunWithBudget(&api_ctx, cmd, strlen(cmd), 1000);
+	api_check("Running a budgeted script after the underflow", 0 == res);
+}
+
+#if !defined(FORTH_WITHOUT_COMPILATION)
+// A script that runs out of its budget again and again, continued by Forth_Resume() until it is done.
+static void api_budget_resume(void)
+{
+	const char *cmd = ": count-up ( -- n ) 0 10000 0 do 1+ loop ; count-up";
+	forth_scell_t res;
+	int resumes = 0;
+
+	res = Forth_RunWithBudget(&api_ctx, cmd, strlen(cmd), 100);
+
+	while ((FORTH_BUDGET_EXHAUSTED == res) && (resumes < 100000))
+	{
+		resumes++;
+		res = Forth_Resume(&api_ctx, 100);
+	}
+
+	api_check("Resuming a script after its budget has run out", (0 == res) && (10 < resumes) &&
+		((api_ctx.sp0 - 1) == api_ctx.sp) && (10000 == api_ctx.sp[0]));
+	api_ctx.sp = api_ctx.sp0;
+}
+#endif
+
+// A clone made in memory that has not been cleared must work.
+static void api_clone(void)
+{
+	static forth_runtime_context_t ctx;
+	static forth_cold_context_t cold;
+	static forth_cell_t data_stack[API_STACK_CELLS];
+	static forth_cell_t return_stack[API_STACK_CELLS];
+	static forth_cell_t search_order[API_SEARCH_ORDER_SIZE];
+	forth_context_init_data_t init_data = { 0 };
+
+	init_data.dictionary = api_ctx.dictionary;
+	init_data.data_stack = data_stack;
+	init_data.data_stack_cell_count = API_STACK_CELLS;
+	init_data.return_stack = return_stack;
+	init_data.return_stack_cell_count = API_STACK_CELLS;
+	init_data.search_order = search_order;
+	init_data.search_order_slots = API_SEARCH_ORDER_SIZE;
+	init_data.cold = &cold;
+
+	memset(&ctx, 0xa5, sizeof(ctx));
+	memset(&cold, 0xa5, sizeof(cold));
+	api_check("Cloning into uninitialized memory", 0 == Forth_CloneContext(&ctx, &api_ctx, &init_data));
+	api_check("Running a script in the clone", api_run(&ctx, ": sq dup * ; 3 sq 9 <> throw s\" 1 2 +\" evaluate 3 <> throw", 0));
+}
+
+#if defined(FORTH_INCLUDE_CHANNELS) && !defined(FORTH_WITHOUT_COMPILATION)
+// Only a channel can be used as one from the application.
+static void api_channels(void)
+{
+	static forth_cell_t not_a_channel[4];
+	void *channel;
+	forth_cell_t x = 0;
+
+	api_check("Defining a channel and a constant", api_run(&api_ctx, "4 channel api-ch 42 constant api-foo", 0));
+	channel = Forth_GetChannel(&api_ctx, "api-ch");
+	api_check("A channel from the application", (0 != channel) && (0 == Forth_ChannelSend(channel, 7)) &&
+		(0 == Forth_ChannelReceive(channel, &x)) && (7 == x));
+	api_check("A constant is not a channel", 0 == Forth_GetChannel(&api_ctx, "api-foo"));
+	api_check("Memory that is not a channel", (-9 == Forth_ChannelSend(not_a_channel, 7)) &&
+		(-9 == Forth_ChannelReceive(not_a_channel, &x)));
+}
+#endif
+
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+// INCLUDE-FILE of a pipe (which cannot tell its position), and of a file with a line longer than the file input buffer.
+static void api_include(void)
+{
+	static const char script[] = "1 2 + drop\n: piped 7 ;\npiped 7 <> throw\n";
+	forth_file_ops_t ops = forth_posix_file_ops;
+	char cmd[64];
+	FILE *f;
+	int fds[2];
+	int i;
+
+	api_ctx.file_ops = &forth_posix_file_ops;
+
+	if ((0 != pipe(fds)) || ((sizeof(script) - 1) != write(fds[1], script, sizeof(script) - 1)) || (0 != close(fds[1])) ||
+		(0 == (f = fdopen(fds[0], "r"))))
+	{
+		api_check("INCLUDE-FILE of a pipe", 0);
+		return;
+	}
+
+	sprintf(cmd, "%lu include-file", (unsigned long)f);
+	api_check("INCLUDE-FILE of a pipe", api_run(&api_ctx, cmd, 0));
+
+	f = fopen("api-long.fs", "w");
+
+	if (0 == f)
+	{
+		api_check("Including a line that is too long", 0);
+		return;
+	}
+
+	fputs("\\ ", f);
+
+	for (i = 0; i < FORTH_FILE_INPUT_BUFFER_LENGTH; i++)
+	{
+		fputc('x', f);
+	}
+
+	fputs("\n", f);
+	fclose(f);
+
+	ops.map = 0;	// Read it a line at a time.
+	api_ctx.file_ops = &ops;
+	api_check("Including a line that is too long", api_run(&api_ctx, "s\" api-long.fs\" included", -18));
+	api_ctx.file_ops = 0;
+	remove("api-long.fs");
+}
+#endif
+
+#if defined(FORTH_INCLUDE_OUTPUT_CAPTURE)
+// Output that does not fit and cannot be spilled, and a spill outliving the heap it has been allocated from.
+static void api_capture(void)
+{
+	static forth_cell_t heap_memory[API_HEAP_SIZE];
+	const char *cmd = "1 . 2 . 3 . 4 . 5 . 6 .";
+	char out[8];
+	forth_cell_t written = 0;
+	forth_scell_t res;
+
+	api_ctx.heap = 0;
+	res = Forth_RunCapture(&api_ctx, cmd, strlen(cmd), out, sizeof(out), &written);
+	api_check("Capture overflow without a heap", (-57 == res) && (8 == written) && (0 == memcmp(out, "1 2 3 4 ", 8)));
+
+	api_ctx.heap = Forth_InitHeap(heap_memory, sizeof(heap_memory));
+	res = Forth_RunCapture(&api_ctx, cmd, strlen(cmd), out, sizeof(out), &written);
+	api_check("Capture spilled to the heap", (0 == res) && (12 == written) && (0 != Forth_GetCaptureSpill(&api_ctx)) &&
+		(0 == memcmp(Forth_GetCaptureSpill(&api_ctx)->data, "5 6 ", 4)));
+
+	api_ctx.heap = 0;
+	res = Forth_RunCapture(&api_ctx, "", 0, out, sizeof(out), &written);
+	api_check("Capture after the heap has been removed", (0 == res) && (0 == written) && (0 == Forth_GetCaptureSpill(&api_ctx)));
+}
+#endif
+
+int main()
+{
+	forth_context_init_data_t init_data = { 0 };
+
+#if defined(FORTH_GUARDED_STACKS)
+	if (0 != forth_guarded_stacks_create(&api_guarded_stacks, API_STACK_CELLS, API_STACK_CELLS, &init_data))
+	{
+		printf("ERROR: Failed to map the stacks!\n");
+		return 1;
+	}
+#else
+	init_data.data_stack = api_data_stack;
+	init_data.data_stack_cell_count = API_STACK_CELLS;
+	init_data.return_stack = api_return_stack;
+	init_data.return_stack_cell_count = API_STACK_CELLS;
+#endif
+	init_data.cold = &api_ctx_cold;
+#if !defined(FORTH_WITHOUT_COMPILATION)
+	init_data.dictionary = Forth_InitDictionary(api_dictionary, sizeof(api_dictionary));
+	init_data.search_order = api_search_order;
+	init_data.search_order_slots = API_SEARCH_ORDER_SIZE;
+#endif
+
+	if (0 > Forth_InitContext(&api_ctx, &init_data))
+	{
+		printf("ERROR: Failed to create Forth runtime context!\n");
+		return 1;
+	}
+#if defined(FORTH_GUARDED_STACKS)
+	if (0 != forth_guarded_stacks_attach(&api_guarded_stacks, &api_ctx))
+	{
+		printf("ERROR: Failed to install the stack fault handler!\n");
+		return 1;
+	}
+#endif
+
+	api_ctx.terminal_width = 80;
+	api_ctx.terminal_height = 25;
+	api_ctx.write_string = &api_write_str;
+	api_ctx.send_cr = &api_send_cr;
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+	api_ctx.eval_cache = Forth_InitEvaluateCache(api_eval_cache_memory, sizeof(api_eval_cache_memory));
+#endif
+
+	api_failing_device();
+	api_budget_underflow();
+#if !defined(FORTH_WITHOUT_COMPILATION)
+	api_budget_resume();
+#endif
+	api_clone();
+#if defined(FORTH_INCLUDE_OUTPUT_CAPTURE)
+	api_capture();
+#endif
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+	api_include();
+#endif
+#if defined(FORTH_INCLUDE_CHANNELS) && !defined(FORTH_WITHOUT_COMPILATION)
+	api_channels();
+#endif
+
+	return 0;
+}
@@ -32,10 +32,14 @@
 extern "C" {
 #endif
 
-#define DICTIONARY_SIZE 512 /* cells */
+#define DICTIONARY_SIZE 2048 /* cells */
 
 extern forth_cell_t dictionary[DICTIONARY_SIZE];
 
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+extern const forth_file_ops_t forth_posix_file_ops;
+#endif
+
 extern int forth_run_forth_stdio(unsigned int dstack_cells, unsigned int rstack_cells, const char *cmd);
 
 #ifdef __cplusplus
@@ -0,0 +1,665 @@
+/*
+* bench.c
+*
+*  Created on: Oct 18, 2026
+*      Author: Andras Zsoter
+*
+* Copyright (c) 2026 Andras Zsoter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+// Small benchmarks for the parallel constructs, each is run with different numbers of worker threads:
+// - the same PAR-DO loop, the speedup is relative to running it without workers,
+// - N jobs incrementing a shared counter with ATOMIC+! (contention), and with a plain +! for comparison.
+// There are also single threaded ones: the speed of the inner interpreter, the ways to get a fresh context for a script,
+// the memory-allocation words (throughput and how much of the heap a random allocation pattern ends up using),
+// how fast the parsing words get through a few megabytes of source (run-bench repeats this one with bench-scalar, which is
+// built without FORTH_SWAR_PARSING), the conversion of numbers, INCLUDED of a big script (mapped in memory or read a line
+// at a time), and getting the output of a script into a buffer.
+// The results are only meaningful on a machine with at least as many idle cores as the largest worker count.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <forth.h>
+#include <forth_internal.h>
+#include "app.h"
+
+#define BENCH_DICTIONARY_SIZE 4096 /* cells */
+#define BENCH_STACK_CELLS 128
+#define BENCH_SEARCH_ORDER_SIZE 16
+#define BENCH_REPEAT 5
+#define BENCH_HEAP_SIZE 262144 /* cells */
+#define BENCH_EVAL_CACHE_SIZE 8192 /* cells */
+
+static forth_cell_t bench_dictionary[BENCH_DICTIONARY_SIZE];
+static forth_cell_t bench_data_stack[BENCH_STACK_CELLS];
+static forth_cell_t bench_return_stack[BENCH_STACK_CELLS];
+static forth_cell_t bench_search_order[BENCH_SEARCH_ORDER_SIZE];
+static forth_runtime_context_t bench_ctx;
+static forth_cold_context_t bench_ctx_cold;
+static forth_cell_t bench_heap_memory[BENCH_HEAP_SIZE];
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+static forth_cell_t bench_eval_cache_memory[BENCH_EVAL_CACHE_SIZE];
+#endif
+
+static const unsigned int bench_worker_counts[] = { 0, 1, 2, 3, 4, 8 };
+static const unsigned int bench_contention_counts[] = { 1, 2, 4, 8 };
+
+#define BENCH_INCREMENTS 200000
+#define BENCH_CONTEXTS 1000000
+#define BENCH_STEPS 4000000
+#define BENCH_ALLOCATIONS 200000
+#define BENCH_SLOTS 256
+#define BENCH_SOURCE_LINES 50000
+#define BENCH_NUMBERS 2000000
+#define BENCH_EVALUATES 200000
+#define BENCH_INCLUDE_FILE "bench-include.fs"
+#define BENCH_REPORT_LINES 20000
+#define BENCH_CAPTURE_SIZE 262144 /* bytes */
+
+#define BENCH_STRING(X) BENCH_STRING2(X)
+#define BENCH_STRING2(X) #X
+
+// Each iteration does a bit of work (an integer hash) so the loop is not dominated by the cost of splitting it.
+static const char bench_definitions[] =
+	": mix ( x -- x' ) 64 0 do dup 7 lshift xor dup 9 rshift xor loop ; "
+	": work ( -- x ) 0 50000 0 ['] + par-do i mix + par-loop ; "
+	"variable counter "
+	": bump ( -- ) " BENCH_STRING(BENCH_INCREMENTS) " 0 do 1 counter atomic+! loop ; "
+	": bump-plain ( -- ) " BENCH_STRING(BENCH_INCREMENTS) " 0 do 1 counter +! loop ; "
+	": step ( x -- x' ) dup 1 and if 2/ else 1+ then ; "
+	": spin ( -- x ) 7 " BENCH_STRING(BENCH_STEPS) " 0 do i + step dup drop loop ; "
+	": contend ( n xt -- n' ) 0 counter ! swap dup >r 0 do 0 over spawn swap loop drop r> 0 do join loop counter @ ; "
+	// Replace a random one of the live blocks with a new one of random size, mostly small but every 16th is up to 4 KiB.
+	"variable seed 1 seed ! "
+	": rnd ( -- x ) seed @ dup 13 lshift xor dup 7 rshift xor dup 17 lshift xor dup seed ! ; "
+	": rsize ( x -- u ) dup 20 rshift 255 and 1+ swap 15 and 0= if 16 * then ; "
+	"create slots " BENCH_STRING(BENCH_SLOTS) " cells allot "
+	": slot ( x -- addr ) 8 rshift " BENCH_STRING(BENCH_SLOTS) " 1- and cells slots + ; "
+	": fill-slots ( -- ) " BENCH_STRING(BENCH_SLOTS) " 0 do 8 allocate drop slots i cells + ! loop ; "
+	": churn ( -- 0 ) " BENCH_STRING(BENCH_ALLOCATIONS) " 0 do rnd dup slot dup @ free drop swap rsize allocate drop swap ! loop 0 ; "
+	": churn-base ( -- 0 ) " BENCH_STRING(BENCH_ALLOCATIONS) " 0 do rnd dup slot dup @ drop swap rsize drop drop loop 0 ; "
+	": scratch ( -- 0 ) " BENCH_STRING(BENCH_ALLOCATIONS) " 0 do arena-mark 64 arena-allocate 2drop arena-release loop 0 ; "
+	": scratch-base ( -- 0 ) " BENCH_STRING(BENCH_ALLOCATIONS) " 0 do 0 64 2drop loop 0 ; "
+	": names ( \"<names>\" -- n ) 0 begin parse-name nip while 1+ repeat ; "
+	": comments ( -- 0 ) 0 ; "
+	": script ( -- c-addr u ) s\" 7 dup 3 + swap over - drop 1000 0x7f and 2drop counter @ drop 12345. 2drop ( done )\" ; "
+	": evals ( -- 0 ) " BENCH_STRING(BENCH_EVALUATES) " 0 do script evaluate loop 0 ; "
+	": evals-base ( -- 0 ) " BENCH_STRING(BENCH_EVALUATES) " 0 do script 2drop loop 0 ; "
+	": report ( -- 0 ) " BENCH_STRING(BENCH_REPORT_LINES) " 0 do i . i 7 * . cr loop 0 ; ";
+
+// The lines of the source for the parsing benchmark: names (with some indentation), and comments of the same length.
+static const char *bench_source_lines[2] =
+{
+	"    : some-word ( addr len -- flag ) over + swap ?do i c@ bl = if unloop true exit then loop false ; \\ Skip it.\r\n",
+	"    ( some-word   addr len -- flag   over + swap ?do i c@ bl = if unloop true exit then loop false ) \\ Skip it.\r\n"
+};
+
+static int bench_write_str(struct forth_runtime_context *rctx, const char *str, forth_cell_t length)
+{
+	fwrite(str, 1, length, stdout);
+	return 0;
+}
+
+static int bench_send_cr(struct forth_runtime_context *rctx)
+{
+	putchar('\n');
+	return 0;
+}
+
+static double bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+// Run CMD with WORKER_COUNT workers, return the best time of BENCH_REPEAT runs in seconds (negative on error).
+// The value CMD leaves on the stack is stored in *RESULT.
+static double bench_run(unsigned int worker_count, const char *cmd, forth_cell_t *result)
+{
+	void *pool = 0;
+	double best = -1.0;
+	double start;
+	double elapsed;
+	int i;
+
+	if (0 != worker_count)
+	{
+		pool = malloc(Forth_GetWorkerPoolSize(worker_count));
+
+		if ((0 == pool) || (0 != Forth_StartWorkers(&bench_ctx, pool, worker_count)))
+		{
+			free(pool);
+			return -1.0;
+		}
+	}
+
+	for (i = 0; i < BENCH_REPEAT; i++)
+	{
+		start = bench_now();
+
+		if (0 != Forth(&bench_ctx, cmd, strlen(cmd), 1))
+		{
+			best = -1.0;
+			break;
+		}
+
+		elapsed = bench_now() - start;
+		*result = *(bench_ctx.sp);
+		best = ((0 > best) || (elapsed < best)) ? elapsed : best;
+	}
+
+	if (0 != worker_count)
+	{
+		Forth_StopWorkers(&bench_ctx);
+		free(pool);
+	}
+
+	return best;
+}
+
+// Run the contention benchmark with the increment word WORD.
+static void bench_contention(const char *word)
+{
+	char cmd[64];
+	forth_cell_t result;
+	double t;
+	unsigned int i;
+	unsigned int n;
+
+	printf("%s: N jobs on N workers, %d increments each\n", word, BENCH_INCREMENTS);
+	printf("   jobs   time [ms]   Mincr/s   lost updates\n");
+
+	for (i = 0; i < (sizeof(bench_contention_counts) / sizeof(bench_contention_counts[0])); i++)
+	{
+		n = bench_contention_counts[i];
+		snprintf(cmd, sizeof(cmd), "%u ' %s contend", n, word);
+		t = bench_run(n, cmd, &result);
+
+		if (0 > t)
+		{
+			printf("%7u   failed\n", n);
+			continue;
+		}
+
+		printf("%7u   %9.2f   %7.2f   %lu\n", n, t * 1000.0, ((double)n * BENCH_INCREMENTS) / (t * 1e6),
+			(unsigned long)(((forth_cell_t)n * BENCH_INCREMENTS) - result));
+	}
+}
+
+// Threaded code running on one context, this mostly measures how fast the inner interpreter is.
+static void bench_interpreter(void)
+{
+	forth_cell_t result;
+	double t = bench_run(0, "spin", &result);
+
+	printf("Inner interpreter (%d iterations, best of %d runs)\n", BENCH_STEPS, BENCH_REPEAT);
+
+	if (0 > t)
+	{
+		printf("failed\n");
+		return;
+	}
+
+	printf("time [ms]   Miterations/s   result\n");
+	printf("%9.2f   %13.2f   %lx\n", t * 1000.0, BENCH_STEPS / (t * 1e6), (unsigned long)result);
+}
+
+// Set up CTX from scratch, the same way as the test application does.
+static void bench_init_context(forth_runtime_context_t *ctx, const forth_context_init_data_t *init_data)
+{
+	memset(ctx, 0, sizeof(forth_runtime_context_t));
+	(void)Forth_InitContext(ctx, init_data);
+	ctx->terminal_width = 80;
+	ctx->terminal_height = 25;
+	ctx->write_string = &bench_write_str;
+	ctx->send_cr = &bench_send_cr;
+}
+
+// Compare Forth_InitContext() (plus setting up the devices), Forth_CloneContext() and Forth_ResetContext().
+static void bench_contexts(void)
+{
+	static forth_runtime_context_t ctx;
+	static forth_cold_context_t cold;
+	static forth_cell_t data_stack[BENCH_STACK_CELLS];
+	static forth_cell_t return_stack[BENCH_STACK_CELLS];
+	static forth_cell_t search_order[BENCH_SEARCH_ORDER_SIZE];
+	forth_context_init_data_t init_data = { 0 };
+	double start;
+	double t[3];
+	int i;
+
+	init_data.dictionary = bench_ctx.dictionary;
+	init_data.data_stack = data_stack;
+	init_data.data_stack_cell_count = BENCH_STACK_CELLS;
+	init_data.return_stack = return_stack;
+	init_data.return_stack_cell_count = BENCH_STACK_CELLS;
+	init_data.search_order = search_order;
+	init_data.search_order_slots = BENCH_SEARCH_ORDER_SIZE;
+	init_data.cold = &cold;
+
+	start = bench_now();
+	for (i = 0; i < BENCH_CONTEXTS; i++)
+	{
+		bench_init_context(&ctx, &init_data);
+		__asm__ __volatile__("" : : "r"(&ctx) : "memory");	// Do not let the compiler drop the loop.
+	}
+	t[0] = bench_now() - start;
+
+	start = bench_now();
+	for (i = 0; i < BENCH_CONTEXTS; i++)
+	{
+		(void)Forth_CloneContext(&ctx, &bench_ctx, &init_data);
+		__asm__ __volatile__("" : : "r"(&ctx) : "memory");
+	}
+	t[1] = bench_now() - start;
+
+	start = bench_now();
+	for (i = 0; i < BENCH_CONTEXTS; i++)
+	{
+		(void)Forth_ResetContext(&ctx);
+		__asm__ __volatile__("" : : "r"(&ctx) : "memory");
+	}
+	t[2] = bench_now() - start;
+
+	printf("Fresh contexts (%d each, context size %lu + %lu bytes)\n", BENCH_CONTEXTS,
+		(unsigned long)sizeof(forth_runtime_context_t), (unsigned long)sizeof(forth_cold_context_t));
+	printf("method    contexts/s\n");
+	printf("init      %10.0f\n", BENCH_CONTEXTS / t[0]);
+	printf("clone     %10.0f\n", BENCH_CONTEXTS / t[1]);
+	printf("reset     %10.0f\n", BENCH_CONTEXTS / t[2]);
+}
+
+// ALLOCATE/FREE and ARENA-ALLOCATE/ARENA-RELEASE, the time of the same loop without the memory words is subtracted.
+// Fragmentation: the part of the heap the blocks have taken from the region compared to what is actually allocated.
+static void bench_memory(void)
+{
+	forth_cell_t result;
+	double t[4];
+
+	(void)Forth(&bench_ctx, "fill-slots", 10, 1);
+	t[0] = bench_run(0, "churn", &result);
+	t[1] = bench_run(0, "churn-base", &result);
+	t[2] = bench_run(0, "scratch", &result);
+	t[3] = bench_run(0, "scratch-base", &result);
+
+	printf("Memory allocation (%d operations, %d live blocks, best of %d runs)\n", BENCH_ALLOCATIONS, BENCH_SLOTS, BENCH_REPEAT);
+
+	if ((0 > t[0]) || (0 > t[1]) || (0 > t[2]) || (0 > t[3]))
+	{
+		printf("failed\n");
+		return;
+	}
+
+	printf("words                          ns/operation\n");
+	printf("free + allocate                %12.1f\n", ((t[0] - t[1]) * 1e9) / BENCH_ALLOCATIONS);
+	printf("arena-mark/allocate/release    %12.1f\n", ((t[2] - t[3]) * 1e9) / BENCH_ALLOCATIONS);
+	printf("live bytes %lu, heap used %lu bytes (%.2f x)\n", (unsigned long)bench_ctx.heap->live,
+		(unsigned long)(bench_ctx.heap->top - bench_ctx.heap->base),
+		(double)(bench_ctx.heap->top - bench_ctx.heap->base) / (double)bench_ctx.heap->live);
+}
+
+#if defined(FORTH_SWAR_PARSING)
+#define BENCH_PARSING "a cell at a time"
+#else
+#define BENCH_PARSING "a byte at a time"
+#endif
+
+// PARSE-NAME on its own, then the text interpreter running ( and \ (which use PARSE) on the same amount of source,
+// then [IF] skipping the names.
+static void bench_parsing(void)
+{
+	const char *words[3] = { "names ", "comments ", "0 [if] " };
+	const char *tails[3] = { "", "", " [then] 0" };
+	forth_cell_t line_length = strlen(bench_source_lines[0]);
+	forth_cell_t result;
+	char *cmd;
+	char *p;
+	double t;
+	int i;
+	int j;
+
+	printf("Parsing, %s (%lu bytes of source, best of %d runs)\n", BENCH_PARSING,
+		(unsigned long)(line_length * BENCH_SOURCE_LINES), BENCH_REPEAT);
+	printf("words        time [ms]      MB/s   result\n");
+
+	for (i = 0; i < 3; i++)
+	{
+		cmd = (char *)malloc(strlen(words[i]) + (line_length * BENCH_SOURCE_LINES) + strlen(tails[i]) + 1);
+
+		if (0 == cmd)
+		{
+			printf("%-9s    failed\n", words[i]);
+			continue;
+		}
+
+		strcpy(cmd, words[i]);
+		p = cmd + strlen(words[i]);
+
+		for (j = 0; j < BENCH_SOURCE_LINES; j++)
+		{
+			memcpy(p, bench_source_lines[i % 2], line_length);
+			p += line_length;
+		}
+
+		strcpy(p, tails[i]);
+		t = bench_run(0, cmd, &result);
+		free(cmd);
+
+		if (0 > t)
+		{
+			printf("%-9s    failed\n", words[i]);
+			continue;
+		}
+
+		printf("%-9s    %9.2f   %7.1f   %lu\n", words[i], t * 1000.0, (line_length * BENCH_SOURCE_LINES) / (t * 1e6),
+			(unsigned long)result);
+	}
+}
+
+// forth_PROCESS_NUMBER() (what the text interpreter does with a word not in the dictionary) on typical literals.
+static void bench_numbers(void)
+{
+	static const char *literals[] = { "7", "42", "-1", "1000", "65535", "-32768", "0x7f", "123456789", "9876543210123", "3.", "12345." };
+	forth_cell_t count = sizeof(literals) / sizeof(literals[0]);
+	forth_cell_t lengths[sizeof(literals) / sizeof(literals[0])];
+	forth_cell_t *sp = bench_ctx.sp;
+	forth_cell_t sum = 0;
+	double best = -1.0;
+	double start;
+	double elapsed;
+	int i;
+	int j;
+
+	for (j = 0; j < (int)count; j++)
+	{
+		lengths[j] = strlen(literals[j]);
+	}
+
+	for (i = 0; i < BENCH_REPEAT; i++)
+	{
+		start = bench_now();
+
+		for (j = 0; j < BENCH_NUMBERS; j++)
+		{
+			(void)forth_PROCESS_NUMBER(&bench_ctx, literals[j % count], lengths[j % count]);
+			sum += bench_ctx.sp[1];
+			bench_ctx.sp = sp;
+		}
+
+		elapsed = bench_now() - start;
+		best = ((0 > best) || (elapsed < best)) ? elapsed : best;
+	}
+
+	printf("Number conversion (%d literals, best of %d runs)\n", BENCH_NUMBERS, BENCH_REPEAT);
+	printf("ns/number   checksum\n");
+	printf("%9.1f   %lx\n", (best * 1e9) / BENCH_NUMBERS, (unsigned long)sum);
+}
+
+// EVALUATE of the same short string over and over again (with and without the evaluate cache).
+static void bench_evaluate(void)
+{
+	forth_cell_t result;
+	double base;
+	double t[2];
+
+	base = bench_run(0, "evals-base", &result);
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+	bench_ctx.eval_cache = 0;
+#endif
+	t[0] = bench_run(0, "evals", &result);
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+	bench_ctx.eval_cache = Forth_InitEvaluateCache(bench_eval_cache_memory, sizeof(bench_eval_cache_memory));
+#endif
+	t[1] = bench_run(0, "evals", &result);
+
+	printf("EVALUATE (%d times, best of %d runs)\n", BENCH_EVALUATES, BENCH_REPEAT);
+	printf("cache   ns/evaluate\n");
+	printf("off     %11.1f\n", ((t[0] - base) * 1e9) / BENCH_EVALUATES);
+	printf("on      %11.1f\n", ((t[1] - base) * 1e9) / BENCH_EVALUATES);
+}
+
+// INCLUDED of a generated script of BENCH_SOURCE_LINES lines, mapped in memory and read a line at a time.
+static void bench_include(void)
+{
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+	static const char line[] = "    7 dup 3 + swap over - drop 1000 0x7f and 2drop counter @ drop ( a comment ) \\ Another one.\n";
+	const char *modes[2] = { "mapped", "streamed" };
+	forth_file_ops_t streamed = forth_posix_file_ops;
+	forth_cell_t line_length = strlen(line);
+	forth_cell_t result;
+	FILE *f;
+	double t;
+	int i;
+
+	f = fopen(BENCH_INCLUDE_FILE, "wb");
+
+	if (0 == f)
+	{
+		printf("INCLUDED failed (cannot create " BENCH_INCLUDE_FILE ")\n");
+		return;
+	}
+
+	for (i = 0; i < BENCH_SOURCE_LINES; i++)
+	{
+		fwrite(line, 1, line_length, f);
+	}
+
+	fclose(f);
+	streamed.map = 0;
+	streamed.unmap = 0;
+
+	printf("INCLUDED (%lu bytes of source, best of %d runs)\n", (unsigned long)(line_length * BENCH_SOURCE_LINES), BENCH_REPEAT);
+	printf("file         time [ms]      MB/s\n");
+
+	for (i = 0; i < 2; i++)
+	{
+		bench_ctx.file_ops = (0 == i) ? &forth_posix_file_ops : &streamed;
+		t = bench_run(0, "s\" " BENCH_INCLUDE_FILE "\" included 0", &result);
+
+		if (0 > t)
+		{
+			printf("%-9s    failed\n", modes[i]);
+			continue;
+		}
+
+		printf("%-9s    %9.2f   %7.1f\n", modes[i], t * 1000.0, (line_length * BENCH_SOURCE_LINES) / (t * 1e6));
+	}
+
+	bench_ctx.file_ops = 0;
+	remove(BENCH_INCLUDE_FILE);
+#endif
+}
+
+#if defined(FORTH_INCLUDE_OUTPUT_CAPTURE)
+static char bench_capture_buffer[BENCH_CAPTURE_SIZE];
+static char bench_device_buffer[BENCH_CAPTURE_SIZE];
+static forth_cell_t bench_device_length;
+
+// An output device that collects the output in a buffer of its own, the way an application would without the capture API.
+static int bench_collect_str(struct forth_runtime_context *rctx, const char *str, forth_cell_t length)
+{
+	if (length > (BENCH_CAPTURE_SIZE - bench_device_length))
+	{
+		return -1;
+	}
+
+	memcpy(bench_device_buffer + bench_device_length, str, length);
+	bench_device_length += length;
+	return 0;
+}
+
+static int bench_collect_cr(struct forth_runtime_context *rctx)
+{
+	return bench_collect_str(rctx, "\n", 1);
+}
+#endif
+
+// The output of a script that prints a report, collected by an output device and copied out, or captured in place.
+static void bench_capture(void)
+{
+#if defined(FORTH_INCLUDE_OUTPUT_CAPTURE)
+	const char *modes[2] = { "device", "capture" };
+	forth_cell_t written = 0;
+	double best[2] = { -1.0, -1.0 };
+	double start;
+	double elapsed;
+	forth_scell_t res;
+	int i;
+	int j;
+
+	for (i = 0; i < BENCH_REPEAT; i++)
+	{
+		for (j = 0; j < 2; j++)
+		{
+			start = bench_now();
+
+			if (0 == j)
+			{
+				bench_ctx.write_string = &bench_collect_str;
+				bench_ctx.send_cr = &bench_collect_cr;
+				bench_device_length = 0;
+				res = Forth(&bench_ctx, "report", 6, 1);
+				memcpy(bench_capture_buffer, bench_device_buffer, bench_device_length);
+				written = bench_device_length;
+				bench_ctx.write_string = &bench_write_str;
+				bench_ctx.send_cr = &bench_send_cr;
+			}
+			else
+			{
+				res = Forth_RunCapture(&bench_ctx, "report", 6, bench_capture_buffer, sizeof(bench_capture_buffer), &written);
+			}
+
+			elapsed = bench_now() - start;
+			best[j] = (0 != res) ? -1.0 : (((0 > best[j]) || (elapsed < best[j])) ? elapsed : best[j]);
+		}
+	}
+
+	printf("Output capture (%lu bytes of output, best of %d runs)\n", (unsigned long)written, BENCH_REPEAT);
+	printf("output       time [ms]\n");
+
+	for (j = 0; j < 2; j++)
+	{
+		if (0 > best[j])
+		{
+			printf("%-9s    failed\n", modes[j]);
+			continue;
+		}
+
+		printf("%-9s    %9.2f\n", modes[j], best[j] * 1000.0);
+	}
+#endif
+}
+
+// With the argument "parsing" only the parsing benchmark is run (see bench-scalar in the Makefile).
+int main(int argc, char *argv[])
+{
+	forth_context_init_data_t init_data = { 0 };
+	forth_cell_t result;
+	double base = 0.0;
+	double t;
+	unsigned int i;
+
+	init_data.dictionary = Forth_InitDictionary(bench_dictionary, sizeof(bench_dictionary));
+	init_data.data_stack = bench_data_stack;
+	init_data.data_stack_cell_count = BENCH_STACK_CELLS;
+	init_data.return_stack = bench_return_stack;
+	init_data.return_stack_cell_count = BENCH_STACK_CELLS;
+	init_data.search_order = bench_search_order;
+	init_data.search_order_slots = BENCH_SEARCH_ORDER_SIZE;
+	init_data.cold = &bench_ctx_cold;
+
+	if (0 > Forth_InitContext(&bench_ctx, &init_data))
+	{
+		printf("ERROR: Failed to create Forth runtime context!\n");
+		return 1;
+	}
+
+	bench_ctx.terminal_width = 80;
+	bench_ctx.terminal_height = 25;
+	bench_ctx.write_string = &bench_write_str;
+	bench_ctx.send_cr = &bench_send_cr;
+	bench_ctx.heap = Forth_InitHeap(bench_heap_memory, sizeof(bench_heap_memory));
+
+	if (0 != Forth(&bench_ctx, bench_definitions, strlen(bench_definitions), 1))
+	{
+		printf("ERROR: Failed to compile the benchmark!\n");
+		return 1;
+	}
+
+	if ((1 < argc) && (0 == strcmp(argv[1], "parsing")))
+	{
+		bench_parsing();
+		return 0;
+	}
+
+	bench_interpreter();
+	printf("\n");
+
+	printf("PAR-DO speedup (best of %d runs)\n", BENCH_REPEAT);
+	printf("workers   time [ms]   speedup   result\n");
+
+	for (i = 0; i < (sizeof(bench_worker_counts) / sizeof(bench_worker_counts[0])); i++)
+	{
+		t = bench_run(bench_worker_counts[i], "work", &result);
+
+		if (0 > t)
+		{
+			printf("%7u   failed\n", bench_worker_counts[i]);
+			continue;
+		}
+
+		base = (0 == i) ? t : base;
+		printf("%7u   %9.2f   %7.2f   %lx\n", bench_worker_counts[i], t * 1000.0, base / t, (unsigned long)result);
+	}
+
+	printf("\n");
+	bench_contention("bump");
+	printf("\n");
+	bench_contention("bump-plain");
+
+	printf("\n");
+	bench_contexts();
+
+	printf("\n");
+	bench_memory();
+
+	printf("\n");
+	bench_parsing();
+
+	printf("\n");
+	bench_numbers();
+
+	printf("\n");
+	bench_evaluate();
+
+	printf("\n");
+	bench_include();
+
+	printf("\n");
+	bench_capture();
+
+	return 0;
+}
@@ -41,6 +41,10 @@ extern "C" {
 
 #define FORTH_TIB_SIZE 256
 #define FORTH_ALLOW_0X_HEX 1
+// Let the parsing words scan the input a cell at a time (bench-scalar is built without it for comparison).
+#if !defined(FORTH_SCALAR_PARSING)
+#define FORTH_SWAR_PARSING 1
+#endif
 
 // #define FORTH_EXCLUDE_DESCRIPTIONS 1
 // #define FORTH_NO_DOUBLES 1
@@ -53,8 +57,28 @@ extern "C" {
 #   define FORTH_MAX_BLOCKS 16
 #endif
 
+#define FORTH_INCLUDE_ATOMICS 1
+#define FORTH_INCLUDE_MEMORY_ALLOCATION 1
+
+// Let guard pages check the stacks instead of PUSH, POP, etc. (Linux, see forth_guard_stacks.c).
+// #define FORTH_GUARDED_STACKS 1
+
 #if !defined(FORTH_WITHOUT_COMPILATION)
 #define FORTH_INCLUDE_LOCALS 1
+#define FORTH_INCLUDE_DICTIONARY_SEGMENTS 1
+#if defined(FORTH_IS_64BIT)
+// Threaded code made of 32 bit tokens.
+#define FORTH_TOKEN_THREADED 1
+#endif
+#if !defined(FORTH_GUARDED_STACKS)
+#define FORTH_INCLUDE_TASKS 1
+#define FORTH_INCLUDE_THREADS 1
+#endif
+#define FORTH_INCLUDE_CHANNELS 1
+#define FORTH_INCLUDE_EVALUATE_CACHE 1
+#define FORTH_INCLUDE_FILE_ACCESS_WORDS 1
+#define FORTH_INCLUDE_OUTPUT_BUFFER 1
+#define FORTH_INCLUDE_OUTPUT_CAPTURE 1
 #endif
 
 #include <forth_config_default.h>
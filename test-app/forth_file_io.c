@@ -0,0 +1,248 @@
+/*
+* forth_file_io.c
+*
+*  Created on: Oct 18, 2026
+*      Author: Andras Zsoter
+*
+* Copyright (c) 2026 Andras Zsoter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <forth.h>
+#include <forth_internal.h>
+#include "app.h"
+
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+// The file system for the file access words: a fileid is a FILE * (stdio does the buffering, so READ-LINE does not
+// have to read a character at a time from the operating system).
+
+#define FILE_NAME_MAX 256
+
+// Copy the file name to BUFFER as a zero terminated string, return 0 if it is too long.
+static int file_name(char *buffer, const char *name, forth_cell_t length)
+{
+	if (length >= FILE_NAME_MAX)
+	{
+		return 0;
+	}
+
+	memcpy(buffer, name, length);
+	buffer[length] = 0;
+	return 1;
+}
+
+static forth_scell_t file_open_mode(const char *name, forth_cell_t length, const char *mode, forth_cell_t *fileid)
+{
+	char buffer[FILE_NAME_MAX];
+	FILE *f;
+
+	if (!file_name(buffer, name, length))
+	{
+		return -38; // Non-existent file.
+	}
+
+	f = fopen(buffer, mode);
+
+	if (0 == f)
+	{
+		return (ENOENT == errno) ? -38 : -37; // Non-existent file / File I/O exception.
+	}
+
+	*fileid = (forth_cell_t)f;
+	return 0;
+}
+
+static forth_scell_t file_open(forth_runtime_context_t *ctx, const char *name, forth_cell_t length, forth_cell_t fam, forth_cell_t *fileid)
+{
+	return file_open_mode(name, length, (FORTH_FAM_WRITE & fam) ? "r+b" : "rb", fileid);
+}
+
+static forth_scell_t file_create(forth_runtime_context_t *ctx, const char *name, forth_cell_t length, forth_cell_t fam, forth_cell_t *fileid)
+{
+	return file_open_mode(name, length, (FORTH_FAM_READ & fam) ? "w+b" : "wb", fileid);
+}
+
+static forth_scell_t file_close(forth_runtime_context_t *ctx, forth_cell_t fileid)
+{
+	return (0 == fclose((FILE *)fileid)) ? 0 : -37;
+}
+
+static forth_scell_t file_read(forth_runtime_context_t *ctx, forth_cell_t fileid, char *buffer, forth_cell_t length, forth_cell_t *count)
+{
+	FILE *f = (FILE *)fileid;
+
+	*count = fread(buffer, 1, length, f);
+	return ferror(f) ? -37 : 0;
+}
+
+// A line ends with LF, CR LF or CR.
+static forth_scell_t file_read_line(forth_runtime_context_t *ctx, forth_cell_t fileid, char *buffer, forth_cell_t length, forth_cell_t *count, forth_cell_t *found)
+{
+	FILE *f = (FILE *)fileid;
+	forth_cell_t n = 0;
+	int c = EOF;
+
+	while (n < length)
+	{
+		c = getc(f);
+
+		if ((EOF == c) || ('\n' == c))
+		{
+			break;
+		}
+
+		if ('\r' == c)
+		{
+			c = getc(f);
+
+			if (('\n' != c) && (EOF != c))
+			{
+				ungetc(c, f);
+			}
+
+			c = '\n';
+			break;
+		}
+
+		buffer[n++] = (char)c;
+	}
+
+	*count = n;
+	*found = ((EOF != c) || (0 != n)) ? 1 : 0;
+	return ferror(f) ? -37 : 0;
+}
+
+static forth_scell_t file_write(forth_runtime_context_t *ctx, forth_cell_t fileid, const char *buffer, forth_cell_t length)
+{
+	return (length == fwrite(buffer, 1, length, (FILE *)fileid)) ? 0 : -37;
+}
+
+static forth_scell_t file_position(forth_runtime_context_t *ctx, forth_cell_t fileid, forth_dcell_t *position)
+{
+	off_t pos = ftello((FILE *)fileid);
+
+	if (0 > pos)
+	{
+		return -37;
+	}
+
+	*position = (forth_dcell_t)pos;
+	return 0;
+}
+
+static forth_scell_t file_reposition(forth_runtime_context_t *ctx, forth_cell_t fileid, forth_dcell_t position)
+{
+	return (0 == fseeko((FILE *)fileid, (off_t)position, SEEK_SET)) ? 0 : -37;
+}
+
+static forth_scell_t file_size(forth_runtime_context_t *ctx, forth_cell_t fileid, forth_dcell_t *size)
+{
+	FILE *f = (FILE *)fileid;
+	struct stat st;
+
+	if ((0 != fflush(f)) || (0 != fstat(fileno(f), &st)))
+	{
+		return -37;
+	}
+
+	*size = (forth_dcell_t)st.st_size;
+	return 0;
+}
+
+static forth_scell_t file_flush(forth_runtime_context_t *ctx, forth_cell_t fileid)
+{
+	return (0 == fflush((FILE *)fileid)) ? 0 : -37;
+}
+
+static forth_scell_t file_remove(forth_runtime_context_t *ctx, const char *name, forth_cell_t length)
+{
+	char buffer[FILE_NAME_MAX];
+
+	if (!file_name(buffer, name, length))
+	{
+		return -38;
+	}
+
+	return (0 == unlink(buffer)) ? 0 : ((ENOENT == errno) ? -38 : -37);
+}
+
+// Map the rest of the file (INCLUDE-FILE interprets it in place), the mapping starts at the page of the file position.
+static forth_scell_t file_map(forth_runtime_context_t *ctx, forth_cell_t fileid, const char **address, forth_cell_t *length)
+{
+	FILE *f = (FILE *)fileid;
+	off_t page = (off_t)sysconf(_SC_PAGESIZE);
+	struct stat st;
+	off_t pos;
+	off_t offset;
+	void *p;
+
+	if ((0 != fflush(f)) || (0 != fstat(fileno(f), &st)) || !S_ISREG(st.st_mode) || (0 > (pos = ftello(f))) || (pos >= st.st_size))
+	{
+		return -21; // Unsupported operation -- read it a line at a time.
+	}
+
+	offset = pos - (pos % page);
+	p = mmap(0, (size_t)(st.st_size - offset), PROT_READ, MAP_PRIVATE, fileno(f), offset);
+
+	if (MAP_FAILED == p)
+	{
+		return -37;
+	}
+
+	(void)posix_madvise(p, (size_t)(st.st_size - offset), POSIX_MADV_SEQUENTIAL); // The interpreter reads it only once, front to back.
+	*address = (const char *)p + (pos - offset);
+	*length = (forth_cell_t)(st.st_size - pos);
+	return 0;
+}
+
+static forth_scell_t file_unmap(forth_runtime_context_t *ctx, forth_cell_t fileid, const char *address, forth_cell_t length)
+{
+	forth_cell_t page = (forth_cell_t)sysconf(_SC_PAGESIZE);
+	forth_cell_t skip = (forth_cell_t)address % page;
+
+	return (0 == munmap((void *)(address - skip), length + skip)) ? 0 : -37;
+}
+
+const forth_file_ops_t forth_posix_file_ops =
+{
+	&file_open,
+	&file_create,
+	&file_close,
+	&file_read,
+	&file_read_line,
+	&file_write,
+	&file_position,
+	&file_reposition,
+	&file_size,
+	&file_flush,
+	&file_remove,
+	&file_map,
+	&file_unmap
+};
+#endif
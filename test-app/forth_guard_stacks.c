@@ -0,0 +1,161 @@
+/*
+* forth_guard_stacks.c
+*
+*  Created on: Oct 18, 2026
+*      Author: Andras Zsoter
+*
+* Copyright (c) 2026 Andras Zsoter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+#include <forth.h>
+#include <forth_internal.h>
+#include "forth_guard_stacks.h"
+
+#if defined(FORTH_GUARDED_STACKS)
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// The layout of the mapping (each stack is a whole number of pages):
+//   guard | data stack | guard | guard | return stack | guard
+// The cell count given to Forth_InitContext() includes one more cell, so sp_max and rp_max are the first cells
+// of the upper guard pages: popping from an empty stack reads them and faults.
+
+static forth_guarded_stacks_t *forth_guarded_list = 0;
+static struct sigaction forth_previous_action;
+static int forth_handler_installed = 0;
+
+// SIGSEGV / SIGBUS handler: turn faults in the guard pages into exceptions in the context that owns them.
+static void forth_guard_fault(int sig, siginfo_t *info, void *uc)
+{
+	forth_guarded_stacks_t *stacks;
+
+	for (stacks = forth_guarded_list; 0 != stacks; stacks = stacks->next)
+	{
+		if (0 != stacks->ctx)
+		{
+			forth_GUARDED_STACK_FAULT(stacks->ctx, info->si_addr, stacks->page_size);	// Does not return if it is ours.
+		}
+	}
+
+	// Not a stack fault, let the previous handler (or the default action) deal with it when the access is retried.
+	sigaction(sig, &forth_previous_action, 0);
+}
+
+static int forth_install_handler(void)
+{
+	struct sigaction action;
+
+	if (forth_handler_installed)
+	{
+		return 0;
+	}
+
+	memset(&action, 0, sizeof(action));
+	action.sa_sigaction = &forth_guard_fault;
+	action.sa_flags = SA_SIGINFO | SA_NODEFER;	// SA_NODEFER: the handler leaves by longjmp(), do not leave the signal blocked.
+	sigemptyset(&action.sa_mask);
+
+	if ((0 != sigaction(SIGSEGV, &action, &forth_previous_action)) || (0 != sigaction(SIGBUS, &action, 0)))
+	{
+		return -1;
+	}
+
+	forth_handler_installed = 1;
+	return 0;
+}
+
+// Map the stacks and fill in the stack fields of INIT_DATA, return 0 on success.
+int forth_guarded_stacks_create(forth_guarded_stacks_t *stacks, forth_cell_t data_stack_cells, forth_cell_t return_stack_cells, forth_context_init_data_t *init_data)
+{
+	forth_cell_t page = (forth_cell_t)sysconf(_SC_PAGESIZE);
+	forth_cell_t data_size = ((data_stack_cells * sizeof(forth_cell_t)) + page - 1) & ~(page - 1);
+	forth_cell_t return_size = ((return_stack_cells * sizeof(forth_cell_t)) + page - 1) & ~(page - 1);
+	char *p;
+
+	memset(stacks, 0, sizeof(forth_guarded_stacks_t));
+	stacks->page_size = page;
+	stacks->mapping_size = (4 * page) + data_size + return_size;
+	stacks->mapping = mmap(0, stacks->mapping_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if (MAP_FAILED == stacks->mapping)
+	{
+		stacks->mapping = 0;
+		return -1;
+	}
+
+	p = (char *)(stacks->mapping);
+
+	if ((0 != mprotect(p + page, data_size, PROT_READ | PROT_WRITE)) ||
+	    (0 != mprotect(p + (3 * page) + data_size, return_size, PROT_READ | PROT_WRITE)))
+	{
+		forth_guarded_stacks_destroy(stacks);
+		return -1;
+	}
+
+	init_data->data_stack = (forth_cell_t *)(p + page);
+	init_data->data_stack_cell_count = (data_size / sizeof(forth_cell_t)) + 1;
+	init_data->return_stack = (forth_cell_t *)(p + (3 * page) + data_size);
+	init_data->return_stack_cell_count = (return_size / sizeof(forth_cell_t)) + 1;
+
+	return 0;
+}
+
+// Let the fault handler know that CTX (initialized with the stacks) uses STACKS.
+// This must be done before other threads are started.
+int forth_guarded_stacks_attach(forth_guarded_stacks_t *stacks, forth_runtime_context_t *ctx)
+{
+	if (0 != forth_install_handler())
+	{
+		return -1;
+	}
+
+	stacks->ctx = ctx;
+	stacks->next = forth_guarded_list;
+	forth_guarded_list = stacks;
+
+	return 0;
+}
+
+void forth_guarded_stacks_destroy(forth_guarded_stacks_t *stacks)
+{
+	forth_guarded_stacks_t **p;
+
+	for (p = &forth_guarded_list; 0 != *p; p = &((*p)->next))
+	{
+		if (stacks == *p)
+		{
+			*p = stacks->next;
+			break;
+		}
+	}
+
+	if (0 != stacks->mapping)
+	{
+		munmap(stacks->mapping, stacks->mapping_size);
+		stacks->mapping = 0;
+	}
+
+	stacks->ctx = 0;
+}
+#endif
@@ -0,0 +1,60 @@
+#ifndef FORTH_GUARD_STACKS_H
+#define FORTH_GUARD_STACKS_H
+/*
+* forth_guard_stacks.h
+*
+*  Created on: Oct 18, 2026
+*      Author: Andras Zsoter
+*
+* Copyright (c) 2026 Andras Zsoter
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <forth.h>
+
+#if defined(FORTH_GUARDED_STACKS)
+// Data and return stacks between PROT_NONE guard pages (Linux / POSIX), for FORTH_GUARDED_STACKS.
+// Usage: forth_guarded_stacks_create(), Forth_InitContext() with the init data filled in by it, then
+// forth_guarded_stacks_attach() before running anything in the context.
+struct forth_guarded_stacks
+{
+	struct forth_guarded_stacks	*next;			// The list of stacks the fault handler knows about.
+	forth_runtime_context_t		*ctx;
+	void						*mapping;
+	forth_cell_t				mapping_size;
+	forth_cell_t				page_size;
+};
+typedef struct forth_guarded_stacks forth_guarded_stacks_t;
+
+extern int forth_guarded_stacks_create(forth_guarded_stacks_t *stacks, forth_cell_t data_stack_cells, forth_cell_t return_stack_cells, forth_context_init_data_t *init_data);
+extern int forth_guarded_stacks_attach(forth_guarded_stacks_t *stacks, forth_runtime_context_t *ctx);
+extern void forth_guarded_stacks_destroy(forth_guarded_stacks_t *stacks);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -28,20 +28,21 @@
 
 #include <stdio.h>
 #include <alloca.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sched.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
 #include <forth.h>
 #include <forth_internal.h>
 #include "app.h"
+#include "forth_guard_stacks.h"
 
 static int write_str(struct forth_runtime_context *rctx, const char *str, forth_cell_t length)
 {
 	rctx->terminal_col += length;
-
-	while(length--)
-	{
-		putchar(*str++);
-	}
-
+	fwrite(str, 1, length, stdout);
 	fflush(stdout);
 	return 0;
 }
@@ -62,9 +63,185 @@ static int send_cr(struct forth_runtime_context *rctx)
 	return 0;
 }
 
+// Piped input (e.g. a script redirected to stdin by run-tests): a reader thread fills two big chunks ahead of the
+// interpreter, so reading the next part of the script overlaps with interpreting the previous one, and ACCEPT takes
+// its lines straight from the chunk that is ready instead of going through stdio for each line.
+#define INPUT_CHUNK_SIZE 65536 /* bytes */
+
+typedef struct
+{
+	char			data[INPUT_CHUNK_SIZE];
+	size_t			length;					// 0 at the end of the input.
+	int				full;					// Filled by the reader, not yet used up by ACCEPT (protected by the lock).
+} input_chunk_t;
+
+typedef struct
+{
+	input_chunk_t	chunks[2];
+	pthread_mutex_t	lock;
+	pthread_cond_t	changed;
+	pthread_t		reader;
+	int				active;					// Non-zero if stdin is read by the reader thread.
+	int				current;				// The chunk ACCEPT is reading from...
+	int				ready;					// ...which is known to be full (no need to take the lock).
+	size_t			position;				// The next character in it.
+} input_pipe_t;
+
+static input_pipe_t input_pipe;
+
+static void *input_reader(void *arg)
+{
+	input_chunk_t *chunk;
+	ssize_t n;
+	int i = 0;
+
+	do
+	{
+		chunk = &(input_pipe.chunks[i]);
+		pthread_mutex_lock(&(input_pipe.lock));
+
+		while (chunk->full)
+		{
+			pthread_cond_wait(&(input_pipe.changed), &(input_pipe.lock));
+		}
+
+		pthread_mutex_unlock(&(input_pipe.lock));
+
+		// Hand over whatever is there, a program feeding the interpreter through a pipe may be waiting for its output.
+		do
+		{
+			n = read(STDIN_FILENO, chunk->data, INPUT_CHUNK_SIZE);
+		}
+		while ((0 > n) && (EINTR == errno));
+
+		pthread_mutex_lock(&(input_pipe.lock));
+		chunk->length = (0 < n) ? (size_t)n : 0;
+		chunk->full = 1;
+		pthread_cond_broadcast(&(input_pipe.changed));
+		pthread_mutex_unlock(&(input_pipe.lock));
+		i ^= 1;
+	}
+	while (0 < n);
+
+	return 0;
+}
+
+// Read stdin with a reader thread if it is not a terminal.
+static void input_pipe_start(void)
+{
+	if (input_pipe.active || isatty(STDIN_FILENO))
+	{
+		return;
+	}
+
+	pthread_mutex_init(&(input_pipe.lock), 0);
+	pthread_cond_init(&(input_pipe.changed), 0);
+
+	if (0 == pthread_create(&(input_pipe.reader), 0, &input_reader, 0))
+	{
+		pthread_detach(input_pipe.reader); // It may be blocked in read() when the application ends.
+		input_pipe.active = 1;
+	}
+}
+
+// Return the chunk ACCEPT is reading from, wait for the reader thread if it is not full yet.
+static input_chunk_t *input_chunk(void)
+{
+	input_chunk_t *chunk = &(input_pipe.chunks[input_pipe.current]);
+
+	if (!input_pipe.ready)
+	{
+		pthread_mutex_lock(&(input_pipe.lock));
+
+		while (!chunk->full)
+		{
+			pthread_cond_wait(&(input_pipe.changed), &(input_pipe.lock));
+		}
+
+		pthread_mutex_unlock(&(input_pipe.lock));
+		input_pipe.ready = 1;
+	}
+
+	return chunk;
+}
+
+// Return the next chunk, the current one (all used up) goes back to the reader thread.
+static input_chunk_t *input_next_chunk(void)
+{
+	pthread_mutex_lock(&(input_pipe.lock));
+	input_pipe.chunks[input_pipe.current].full = 0;
+	pthread_cond_broadcast(&(input_pipe.changed));
+	pthread_mutex_unlock(&(input_pipe.lock));
+
+	input_pipe.current ^= 1;
+	input_pipe.ready = 0;
+	input_pipe.position = 0;
+	return input_chunk();
+}
+
+// The next character of the input, EOF at the end.
+static int input_getc(void)
+{
+	input_chunk_t *chunk = input_chunk();
+
+	while (input_pipe.position >= chunk->length)
+	{
+		if (0 == chunk->length)
+		{
+			return EOF;
+		}
+
+		chunk = input_next_chunk();
+	}
+
+	return (unsigned char)(chunk->data[input_pipe.position++]);
+}
+
+// The same as fgets(buffer, length - 1, stdin) below: at most LENGTH - 2 characters, the line end is kept.
+static forth_scell_t input_accept(char *buffer, forth_cell_t length)
+{
+	input_chunk_t *chunk = input_chunk();
+	forth_cell_t count = 0;
+	const char *start;
+	const char *eol = 0;
+	size_t n;
+
+	while ((0 == eol) && ((count + 2) < length))
+	{
+		if (input_pipe.position >= chunk->length)
+		{
+			if (0 == chunk->length)
+			{
+				return (0 == count) ? -1 : (forth_scell_t)count;
+			}
+
+			chunk = input_next_chunk();
+			continue;
+		}
+
+		start = chunk->data + input_pipe.position;
+		n = chunk->length - input_pipe.position;
+		n = (n < (length - 2 - count)) ? n : (size_t)(length - 2 - count);
+		eol = (const char *)memchr(start, '\n', n);
+		n = (0 != eol) ? (size_t)(eol + 1 - start) : n;
+
+		memcpy(buffer + count, start, n);
+		count += n;
+		input_pipe.position += n;
+	}
+
+	return (forth_scell_t)count;
+}
+
 static forth_scell_t accept_str(struct forth_runtime_context *rctx, char *buffer, forth_cell_t length)
 {
 	char *res;
+
+	if (input_pipe.active)
+	{
+		return input_accept(buffer, length);
+	}
+
 	// This is not actually correct, but will do for now.
 	res = fgets(buffer, length - 1, stdin);
 	if (0 == res)
@@ -81,7 +258,7 @@ static forth_scell_t accept_str(struct forth_runtime_context *rctx, char *buffer
 // KEY? and EKEY? cannot be implemented using stdio, they would need something like a low level terminal interface.
 static forth_cell_t key(struct forth_runtime_context *rctx)
 {
-	char c = getchar();
+	char c = input_pipe.active ? input_getc() : getchar();
 	return (forth_cell_t)c;
 }
 
@@ -92,7 +269,7 @@ static forth_cell_t key_q(struct forth_runtime_context *rctx)
 
 static forth_cell_t ekey(struct forth_runtime_context *rctx)
 {
-	char c = getchar();
+	char c = input_pipe.active ? input_getc() : getchar();
 	return ((forth_cell_t)c) << 8;
 }
 
@@ -106,13 +283,61 @@ static forth_cell_t ekey_to_char(struct forth_runtime_context *rctx, forth_cell_
 	return ek >> 8;
 }
 
+// Called while a blocking word (e.g. RECV) is waiting for another thread.
+static int pause_hook(struct forth_runtime_context *rctx)
+{
+	sched_yield();
+	return 0;
+}
+
 forth_dictionary_t *dict = 0;
 
 #if defined(FORTH_INCLUDE_BLOCKS)
 forth_block_buffers_t block_buffers;
 #endif
 
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION)
+#define HEAP_SIZE 16384 /* cells */
+forth_cell_t heap_memory[HEAP_SIZE];
+forth_heap_t *heap = 0;
+#endif
+
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+#define EVAL_CACHE_SIZE 8192 /* cells */
+forth_cell_t eval_cache_memory[EVAL_CACHE_SIZE];
+#endif
+
 #define SEARCH_ORDER_SIZE 32 /* Perhaps move this to some header file at one point. */
+#define WORKER_COUNT 4
+
+#if defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+#define SEGMENT_SIZE 4096 /* bytes */
+#define SEGMENT_POOL_SIZE 131072 /* cells */
+
+// The segments are taken from a static pool rather than malloc(): with token threaded code they must be within the reach
+// of a token from the dictionary (see Forth_SetSegmentProvider()), which memory from the heap need not be.
+static forth_cell_t segment_pool[SEGMENT_POOL_SIZE];
+static forth_cell_t segment_pool_used = 0; /* bytes */
+
+// Give the dictionary more memory when the static area is full (it is never freed, just like the dictionary itself).
+static void *more_dictionary(forth_dictionary_t *dictionary, forth_cell_t min_length, forth_cell_t *length)
+{
+	forth_cell_t size = (min_length > SEGMENT_SIZE) ? min_length : SEGMENT_SIZE;
+	void *segment;
+
+	size = (size + sizeof(forth_cell_t) - 1) & ~(sizeof(forth_cell_t) - 1);
+
+	if (size > (sizeof(segment_pool) - segment_pool_used))
+	{
+		return 0;
+	}
+
+	segment = ((char *)segment_pool) + segment_pool_used;
+	segment_pool_used += size;
+	*length = size;
+	return segment;
+}
+#endif
 // ------------------------------------------------------------------------------------------------
 int forth_run_forth_stdio(unsigned int dstack_cells, unsigned int rstack_cells, const char *cmd)
 {
@@ -122,7 +347,13 @@ int forth_run_forth_stdio(unsigned int dstack_cells, unsigned int rstack_cells,
 	forth_cell_t *rp;
 	forth_cell_t *search_order;
 	forth_context_init_data_t init_data = { 0 };
-	forth_cell_t size = sizeof(struct forth_runtime_context) + sizeof(forth_cell_t) * (dstack_cells + rstack_cells + (SEARCH_ORDER_SIZE));
+#if defined(FORTH_INCLUDE_THREADS)
+	void *worker_pool;
+#endif
+#if defined(FORTH_GUARDED_STACKS)
+	forth_guarded_stacks_t guarded_stacks;
+#endif
+	forth_cell_t size = sizeof(struct forth_runtime_context) + sizeof(forth_cell_t) * (dstack_cells + rstack_cells + (SEARCH_ORDER_SIZE)) + sizeof(forth_cold_context_t);
 
     char *ctx = alloca(size);
 
@@ -139,6 +370,7 @@ int forth_run_forth_stdio(unsigned int dstack_cells, unsigned int rstack_cells,
     rp = sp + dstack_cells;
     search_order = rp + rstack_cells;
 
+	init_data.cold = (forth_cold_context_t *)(search_order + (SEARCH_ORDER_SIZE));
 	init_data.data_stack = sp;
 	init_data.data_stack_cell_count = dstack_cells;
 	init_data.return_stack = rp;
@@ -148,6 +380,9 @@ int forth_run_forth_stdio(unsigned int dstack_cells, unsigned int rstack_cells,
 	if (0 == dict)
 	{
 		dict = Forth_InitDictionary(dictionary, sizeof(dictionary));
+#if defined(FORTH_INCLUDE_DICTIONARY_SEGMENTS)
+		Forth_SetSegmentProvider(dict, &more_dictionary);
+#endif
 	}
 
 	init_data.dictionary = dict;
@@ -155,6 +390,14 @@ int forth_run_forth_stdio(unsigned int dstack_cells, unsigned int rstack_cells,
 	init_data.search_order_slots = (SEARCH_ORDER_SIZE);
 #endif
 
+#if defined(FORTH_GUARDED_STACKS)
+	if (0 != forth_guarded_stacks_create(&guarded_stacks, dstack_cells, rstack_cells, &init_data))
+	{
+		printf("ERROR: Failed to map the stacks!\r\n");
+		return -1;
+	}
+#endif
+
 	res = Forth_InitContext(rctx, &init_data);
 
 	if (0 > res)
@@ -162,6 +405,14 @@ int forth_run_forth_stdio(unsigned int dstack_cells, unsigned int rstack_cells,
 		return (int)res;
 	}
 
+#if defined(FORTH_GUARDED_STACKS)
+	if (0 != forth_guarded_stacks_attach(&guarded_stacks, rctx))
+	{
+		printf("ERROR: Failed to install the stack fault handler!\r\n");
+		return -1;
+	}
+#endif
+
    	rctx->terminal_width = 80;
    	rctx->terminal_height = 25;
    	rctx->write_string = &write_str;
@@ -171,11 +422,13 @@ int forth_run_forth_stdio(unsigned int dstack_cells, unsigned int rstack_cells,
 #endif
    	rctx->send_cr = &send_cr;
     rctx->accept_string = &accept_str;
+    input_pipe_start();
    	rctx->key = &key;
    	rctx->key_q = &key_q;
    	rctx->ekey = &ekey;
    	rctx->ekey_q = &ekey_q;
    	rctx->ekey_to_char = &ekey_to_char;
+   	rctx->pause = &pause_hook;
 
 #if defined(FORTH_INCLUDE_BLOCKS)
 	memset(&block_buffers, 0, sizeof(block_buffers));
@@ -183,7 +436,42 @@ int forth_run_forth_stdio(unsigned int dstack_cells, unsigned int rstack_cells,
 	rctx->block_buffers = &block_buffers;
 #endif
 
+#if defined(FORTH_INCLUDE_MEMORY_ALLOCATION)
+	if (0 == heap)
+	{
+		heap = Forth_InitHeap(heap_memory, sizeof(heap_memory));
+	}
+
+	rctx->heap = heap;
+#endif
+
+#if defined(FORTH_INCLUDE_EVALUATE_CACHE)
+	rctx->eval_cache = Forth_InitEvaluateCache(eval_cache_memory, sizeof(eval_cache_memory));
+#endif
+
+#if defined(FORTH_INCLUDE_FILE_ACCESS_WORDS)
+	rctx->file_ops = &forth_posix_file_ops;
+#endif
+
+#if defined(FORTH_INCLUDE_THREADS)
+	worker_pool = malloc(Forth_GetWorkerPoolSize(WORKER_COUNT));
+
+	if ((0 == worker_pool) || (0 != Forth_StartWorkers(rctx, worker_pool, WORKER_COUNT)))
+	{
+		printf("ERROR: Failed to start the worker threads!\r\n");
+	}
+#endif
+
     res = Forth(rctx, cmd, strlen(cmd), 1);
 
+#if defined(FORTH_INCLUDE_THREADS)
+	Forth_StopWorkers(rctx);
+	free(worker_pool);
+#endif
+
+#if defined(FORTH_GUARDED_STACKS)
+	forth_guarded_stacks_destroy(&guarded_stacks);
+#endif
+
     return (int)res;
 }
@@ -25,6 +25,7 @@ forth_cell_t dictionary[DICTIONARY_SIZE];
 forth_cell_t data_stack[STACK_SIZE];
 forth_cell_t return_stack[STACK_SIZE];
 forth_runtime_context_t r_ctx;
+forth_cold_context_t r_ctx_cold;
 //struct forth_persistent_context p_ctx;
 
 forth_cell_t search_order[SEARCH_ORDER_SIZE];
@@ -255,6 +256,7 @@ int main()
 	init_data.dictionary = dict;
 	init_data.search_order = search_order;
 	init_data.search_order_slots = (SEARCH_ORDER_SIZE);
+	init_data.cold = &r_ctx_cold;
 
 	res = Forth_InitContext(&r_ctx, &init_data);
 